@@ -0,0 +1,119 @@
+/// Cost of copying and destroying sstd::ownership with each ownership_policy,
+/// when the threads copy their own objects and when they copy the same object.
+///
+/// Usage: bench_ownership [max_thread_count]
+///
+/// Prints results as JSON to stdout.
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "hycc/sstd.hpp"
+
+namespace {
+
+using hycc::sstd::ownership_policy;
+
+inline constexpr auto copies_per_thread = 10'000'000uz;
+
+struct result {
+    std::string_view policy;
+    bool shared;
+    std::size_t threads;
+    double seconds;
+};
+
+/// Copies and destroys an ownership copies_per_thread times on each thread.
+template<ownership_policy Policy>
+void copy_loop(const hycc::sstd::ownership<int, Policy>& original) {
+    for (auto i = 0uz; i < copies_per_thread; ++i) {
+        auto copy = original;
+        // Keep the copy from being optimized away.
+        asm volatile("" : : "r"(&copy) : "memory");
+    }
+}
+
+/// Ownership of a new object, or borrowed view of \p object.
+template<ownership_policy Policy>
+[[nodiscard]] auto make_ownership(const int& object) -> hycc::sstd::ownership<int, Policy> {
+    if constexpr (Policy == ownership_policy::borrowed) {
+        return hycc::sstd::ownership<int, Policy>{ object };
+    } else {
+        return hycc::sstd::make_shared_object<int, Policy>(object);
+    }
+}
+
+/// Runs copy_loop on \p threads threads, which copy the same ownership if \p shared.
+template<ownership_policy Policy>
+[[nodiscard]] auto measure(const std::string_view policy,
+                           const bool shared,
+                           const std::size_t threads) -> result {
+    const auto object = 42;
+    auto ownerships   = std::vector<hycc::sstd::ownership<int, Policy>>{};
+    for (auto i = 0uz; i < threads; ++i) {
+        if (shared and i != 0) {
+            ownerships.push_back(ownerships.front());
+        } else {
+            ownerships.push_back(make_ownership<Policy>(object));
+        }
+    }
+
+    auto start_line = std::barrier{ static_cast<std::ptrdiff_t>(threads + 1) };
+    auto workers    = std::vector<std::jthread>{};
+    for (auto i = 0uz; i < threads; ++i) {
+        workers.emplace_back([&, i] {
+            start_line.arrive_and_wait();
+            copy_loop<Policy>(shared ? ownerships.front() : ownerships[i]);
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    start_line.arrive_and_wait();
+    workers.clear();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return { policy, shared, threads, std::chrono::duration<double>(elapsed).count() };
+}
+
+[[nodiscard]] auto to_json(const result& r) -> std::string {
+    // Threads copy at the same time, so each copy of a thread takes this long.
+    const auto nanoseconds_per_copy = r.seconds * 1e9 / static_cast<double>(copies_per_thread);
+    return std::format(R"({{"policy": "{}", "shared_object": {}, "threads": {}, )"
+                       R"("seconds": {:.6f}, "nanoseconds_per_copy": {:.3f}}})",
+                       r.policy,
+                       r.shared,
+                       r.threads,
+                       r.seconds,
+                       nanoseconds_per_copy);
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[]) {
+    auto max_threads = std::max(1uz, static_cast<std::size_t>(std::thread::hardware_concurrency()));
+    if (argc > 1) max_threads = std::stoull(argv[1]);
+
+    auto results = std::vector<std::string>{};
+    for (auto threads = 1uz; threads <= max_threads; threads *= 2) {
+        // Single threaded ownership can not be shared between threads.
+        results.push_back(
+            to_json(measure<ownership_policy::single_threaded>("single_threaded", false, threads)));
+        results.push_back(to_json(measure<ownership_policy::atomic>("atomic", false, threads)));
+        results.push_back(to_json(measure<ownership_policy::atomic>("atomic", true, threads)));
+        results.push_back(to_json(measure<ownership_policy::borrowed>("borrowed", true, threads)));
+    }
+
+    std::cout << "{\"benchmarks\": [\n";
+    for (auto i = 0uz; i < results.size(); ++i) {
+        std::cout << "    " << results[i] << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    std::cout << "]}\n";
+}
@@ -0,0 +1,87 @@
+/// Time of parsing a global scope of growing number of items.
+///
+/// Parsing is linear in the number of items, so time per item should not grow with it.
+/// Linear growth of the work is checked by test_parser, this only reports the times.
+///
+/// Usage: bench_parser [max_items]
+///
+/// Prints results as JSON to stdout.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hycc/ast.hpp"
+#include "hycc/parser.hpp"
+#include "hycc/tokenizer.hpp"
+
+namespace {
+
+struct result {
+    std::size_t items;
+    double seconds;
+};
+
+/// Tokens of global scope of \p items nested scopes.
+[[nodiscard]] auto make_tokens(const std::size_t items) -> hycc::token_buffer {
+    auto text = std::u8string{};
+    for (auto i = 0uz; i < items; ++i) text += u8"{}\n";
+    auto source = hycc::source_code{ std::move(text) };
+    return hycc::tokenize(source);
+}
+
+/// Fastest of a few parses of global scope of \p items nested scopes.
+[[nodiscard]] auto measure(const std::size_t items) -> result {
+    const auto tokens = make_tokens(items);
+
+    using clock  = std::chrono::steady_clock;
+    auto fastest = clock::duration::max();
+    for (auto run = 0; run < 5; ++run) {
+        auto parser       = hycc::parser_t{ tokens };
+        auto global_scope = hycc::ast::scope_node{};
+        global_scope.mark_as_global_scope();
+
+        const auto start              = clock::now();
+        [[maybe_unused]] const auto _ = global_scope.push(parser);
+        fastest                       = std::min(fastest, clock::now() - start);
+
+        if (global_scope.get_ordered_property().size() != items)
+            throw std::runtime_error{ "Global scope was not parsed!" };
+    }
+    return { .items = items, .seconds = std::chrono::duration<double>(fastest).count() };
+}
+
+[[nodiscard]] auto ns_per_item(const result& r) -> double {
+    return r.seconds * 1e9 / static_cast<double>(r.items);
+}
+
+[[nodiscard]] auto to_json(const result& r) -> std::string {
+    return std::format(R"({{"items": {}, "seconds": {:.6f}, "ns_per_item": {:.3f}}})",
+                       r.items,
+                       r.seconds,
+                       ns_per_item(r));
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[]) {
+    auto max_items = 640'000uz;
+    if (argc > 1) max_items = std::stoull(argv[1]);
+
+    auto results = std::vector<result>{};
+    for (auto items = 10'000uz; items <= max_items; items *= 4) {
+        results.push_back(measure(items));
+    }
+
+    std::cout << "{\"benchmarks\": [\n";
+    for (auto i = 0uz; i < results.size(); ++i) {
+        std::cout << "    " << to_json(results[i]) << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    std::cout << "]}\n";
+}
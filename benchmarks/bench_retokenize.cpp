@@ -0,0 +1,146 @@
+/// Time of retokenizing a single character edit in the middle of sources of growing size.
+///
+/// Retokenizing a copy copies every token, while retokenizing in place only shifts
+/// the offsets of the tokens after the edit, so both grow linearly with the size,
+/// but the latter with a much smaller constant. Both are compared to tokenizing from scratch.
+/// Building the edited source_code, which retokenizing in place includes, is timed on its own,
+/// as it copies the source and indexes its lines.
+///
+/// An edit is linear in the size of the source, so the benchmark fails if retokenizing in place
+/// is not at least twice as fast as tokenizing from scratch at the largest size.
+///
+/// Usage: bench_retokenize [max_size_in_bytes]
+///
+/// Prints results as JSON to stdout.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "hycc/incremental_tokenizer.hpp"
+#include "hycc/tokenizer.hpp"
+
+namespace {
+
+struct result {
+    std::string_view method;
+    std::size_t bytes;
+    double seconds;
+};
+
+/// Source with repeating lines of code, which is at least \p size bytes long.
+[[nodiscard]] auto make_source(const std::size_t size) -> std::u8string {
+    constexpr auto line = std::u8string_view{ u8"foo = bar + 42; /* comment */ \"literal\"\n" };
+    auto str            = std::u8string{};
+    str.reserve(size + line.size());
+    while (str.size() < size) str.append(line);
+    return str;
+}
+
+/// Average time of \p f over enough repetitions to take at least 100 ms.
+[[nodiscard]] auto time_of(auto&& f) -> double {
+    using clock      = std::chrono::steady_clock;
+    auto repetitions = 0uz;
+    const auto start = clock::now();
+    auto elapsed     = clock::duration{};
+    do {
+        f();
+        ++repetitions;
+        elapsed = clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds{ 100 });
+    return std::chrono::duration<double>(elapsed).count() / static_cast<double>(repetitions);
+}
+
+[[nodiscard]] auto measure(const std::size_t size) -> std::vector<result> {
+    const auto str = make_source(size);
+    // Replaces the space before "bar" in the middle line with a tab.
+    const auto offset  = str.size() / 2 - str.size() / 2 % 40 + 5;
+    const auto edit    = hycc::text_edit{ offset, 1, 1 };
+    auto edited_str    = str;
+    edited_str[offset] = u8'\t';
+
+    auto source         = hycc::source_code{ std::u8string{ str } };
+    const auto previous = hycc::tokenize(source);
+
+    const auto copy = time_of([&] {
+        auto edited                   = hycc::source_code{ std::u8string{ edited_str } };
+        [[maybe_unused]] const auto _ = hycc::retokenize(previous, edited, edit);
+    });
+
+    // Edits the same buffer back and forth, so that no copy of it is needed.
+    auto buffer         = hycc::tokenize(source);
+    auto strs           = std::pair{ str, edited_str };
+    const auto in_place = time_of([&] {
+        auto edited = hycc::source_code{ std::u8string{ strs.second } };
+        buffer      = hycc::retokenize(std::move(buffer), edited, edit);
+        std::swap(strs.first, strs.second);
+    });
+
+    const auto source_only = time_of([&] {
+        [[maybe_unused]] const auto edited = hycc::source_code{ std::u8string{ edited_str } };
+    });
+
+    const auto scratch = time_of([&] {
+        auto edited                   = hycc::source_code{ std::u8string{ edited_str } };
+        [[maybe_unused]] const auto _ = hycc::tokenize(edited);
+    });
+
+    return { { "retokenize_copy", str.size(), copy },
+             { "retokenize_in_place", str.size(), in_place },
+             { "source_code", str.size(), source_only },
+             { "tokenize", str.size(), scratch } };
+}
+
+/// Retokenizing in place has to be this many times faster than tokenizing from scratch.
+constexpr auto min_speedup = 2.0;
+
+[[nodiscard]] auto seconds_of(const std::vector<result>& results, const std::string_view method)
+    -> double {
+    return std::ranges::find(results, method, &result::method)->seconds;
+}
+
+[[nodiscard]] auto to_json(const result& r) -> std::string {
+    return std::format(R"({{"method": "{}", "bytes": {}, "seconds": {:.9f}, )"
+                       R"("ns_per_byte": {:.3f}}})",
+                       r.method,
+                       r.bytes,
+                       r.seconds,
+                       r.seconds * 1e9 / static_cast<double>(r.bytes));
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[]) {
+    auto max_size = 16uz * 1024uz * 1024uz;
+    if (argc > 1) max_size = std::stoull(argv[1]);
+
+    auto results = std::vector<std::string>{};
+    auto largest = std::vector<result>{};
+    for (auto size = 1024uz; size <= max_size; size *= 4) {
+        largest = measure(size);
+        for (const auto& r : largest) results.push_back(to_json(r));
+    }
+
+    std::cout << "{\"benchmarks\": [\n";
+    for (auto i = 0uz; i < results.size(); ++i) {
+        std::cout << "    " << results[i] << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    std::cout << "]}\n";
+
+    if (largest.empty()) return 0;
+    const auto speedup =
+        seconds_of(largest, "tokenize") / seconds_of(largest, "retokenize_in_place");
+    if (speedup < min_speedup) {
+        std::cerr << std::format("Retokenizing in place is only {:.1f} times faster than "
+                                 "tokenizing {} bytes from scratch!\n",
+                                 speedup,
+                                 largest.front().bytes);
+        return 1;
+    }
+}
@@ -0,0 +1,116 @@
+/// Time of reading a single long token with hycc::token_stream in chunks.
+///
+/// Token continues over many chunks, so time per byte should not grow with the size.
+///
+/// Usage: bench_token_stream [max_size_in_bytes]
+///
+/// Prints results as JSON to stdout.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "hycc/token_stream.hpp"
+
+namespace {
+
+/// Anonymous temporary file, which is removed when closed.
+class temporary_file {
+    std::FILE* file_;
+
+  public:
+    explicit temporary_file(const std::u8string_view content) : file_{ std::tmpfile() } {
+        if (file_ == nullptr) throw std::runtime_error{ "tmpfile failed" };
+        if (std::fwrite(content.data(), 1, content.size(), file_) != content.size())
+            throw std::runtime_error{ "write to tmpfile failed" };
+        std::fflush(file_);
+    }
+    temporary_file(const temporary_file&)            = delete;
+    temporary_file& operator=(const temporary_file&) = delete;
+    ~temporary_file() { std::fclose(file_); }
+
+    /// File descriptor positioned at the beginning of the file.
+    [[nodiscard]] auto rewound_fd() const -> int {
+        ::lseek(::fileno(file_), 0, SEEK_SET);
+        return ::fileno(file_);
+    }
+};
+
+struct result {
+    std::string_view token;
+    std::string_view mode;
+    std::size_t bytes;
+    double seconds;
+    std::size_t peak_buffered;
+};
+
+[[nodiscard]] auto measure(const std::string_view token,
+                           const std::u8string_view begin,
+                           const char8_t body,
+                           const std::u8string_view end,
+                           const hycc::trivia_mode mode,
+                           const std::size_t size) -> result {
+    auto str = std::u8string{ begin };
+    str.append(size, body);
+    str.append(end);
+    const auto file = temporary_file{ str };
+
+    using clock      = std::chrono::steady_clock;
+    const auto start = clock::now();
+    auto stream      = hycc::token_stream{ file.rewound_fd(), mode };
+    auto peak        = 0uz;
+    for ([[maybe_unused]] const auto& _ : stream) peak = std::max(peak, stream.buffered());
+    const auto elapsed = clock::now() - start;
+
+    return { .token         = token,
+             .mode          = mode == hycc::trivia_mode::in_stream ? "in_stream" : "side_table",
+             .bytes         = str.size(),
+             .seconds       = std::chrono::duration<double>(elapsed).count(),
+             .peak_buffered = peak };
+}
+
+[[nodiscard]] auto to_json(const result& r) -> std::string {
+    return std::format(R"({{"token": "{}", "mode": "{}", "bytes": {}, "seconds": {:.6f}, )"
+                       R"("ns_per_byte": {:.3f}, "peak_buffered": {}}})",
+                       r.token,
+                       r.mode,
+                       r.bytes,
+                       r.seconds,
+                       r.seconds * 1e9 / static_cast<double>(r.bytes),
+                       r.peak_buffered);
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[]) {
+    auto max_size = 32uz * 1024uz * 1024uz;
+    if (argc > 1) max_size = std::stoull(argv[1]);
+
+    auto results = std::vector<std::string>{};
+    for (const auto mode : { hycc::trivia_mode::in_stream, hycc::trivia_mode::side_table }) {
+        for (auto size = 1024uz * 1024uz; size <= max_size; size *= 4) {
+            const auto comment    = measure("block_comment", u8"a /*", u8'x', u8"*/ b", mode, size);
+            const auto literal    = measure("literal", u8"a \"", u8'x', u8"\" b", mode, size);
+            const auto identifier = measure("identifier", u8"a ", u8'x', u8" b", mode, size);
+            results.push_back(to_json(comment));
+            results.push_back(to_json(literal));
+            results.push_back(to_json(identifier));
+        }
+    }
+
+    std::cout << "{\"benchmarks\": [\n";
+    for (auto i = 0uz; i < results.size(); ++i) {
+        std::cout << "    " << results[i] << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    std::cout << "]}\n";
+}
@@ -0,0 +1,176 @@
+/// Throughput of hycc::tokenize on synthetic source codes.
+///
+/// Usage: bench_tokenizer [max_size_in_bytes]
+///
+/// Prints results as JSON to stdout.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "hycc/tokenizer.hpp"
+
+#include "allocation_counter.hpp"
+
+namespace {
+
+/// Deterministic pseudo random numbers, so the corpora are the same on every run.
+class random_generator {
+    std::uint32_t seed_ = 12345;
+
+  public:
+    /// Random number in [0, n).
+    [[nodiscard]] auto operator()(const std::size_t n) -> std::size_t {
+        seed_ = seed_ * 1664525u + 1013904223u;
+        return (seed_ >> 8) % n;
+    }
+};
+
+/// Appends a random piece of source code to the string.
+using corpus_generator = std::function<void(std::u8string&, random_generator&)>;
+
+void append_identifier(std::u8string& str, random_generator& random) {
+    constexpr auto first =
+        std::u8string_view{ u8"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_" };
+    constexpr auto rest = std::u8string_view{ u8"abcdefghijklmnopqrstuvwxyz_0123456789" };
+    str.push_back(first[random(first.size())]);
+    for (auto n = random(12); n != 0; --n) str.push_back(rest[random(rest.size())]);
+}
+
+void identifier_heavy(std::u8string& str, random_generator& random) {
+    append_identifier(str, random);
+    str.push_back(random(8) == 0 ? u8'\n' : u8' ');
+}
+
+void operator_heavy(std::u8string& str, random_generator& random) {
+    constexpr auto operators = std::u8string_view{ u8"!#$%&*+-/<=>?@\\^|~" };
+    append_identifier(str, random);
+    for (auto n = random(4) + 1; n != 0; --n) str.push_back(operators[random(operators.size())]);
+    if (random(16) == 0) str.append(u8";\n");
+}
+
+void block_comments(std::u8string& str, random_generator& random) {
+    str.append(u8"/*");
+    for (auto n = random(64) + 16; n != 0; --n) {
+        append_identifier(str, random);
+        str.push_back(random(10) == 0 ? u8'\n' : u8' ');
+    }
+    str.append(u8"*/\n");
+}
+
+void long_literals(std::u8string& str, random_generator& random) {
+    str.push_back(u8'"');
+    for (auto n = random(64) + 16; n != 0; --n) {
+        append_identifier(str, random);
+        str.append(random(10) == 0 ? u8"\\\" " : u8" ");
+    }
+    str.append(u8"\";\n");
+}
+
+void nested_braces(std::u8string& str, random_generator& random) {
+    const auto depth = random(256) + 1;
+    for (auto i = 0uz; i < depth; ++i) str.append(i % 2 == 0 ? u8"{" : u8"(");
+    append_identifier(str, random);
+    for (auto i = depth; i != 0; --i) str.append((i - 1) % 2 == 0 ? u8"}" : u8")");
+    str.push_back(u8'\n');
+}
+
+[[nodiscard]] auto generate(const corpus_generator& generator, const std::size_t size)
+    -> std::u8string {
+    auto random = random_generator{};
+    auto str    = std::u8string{};
+    str.reserve(size + 4096);
+    while (str.size() < size) generator(str, random);
+    str.resize(size);
+    return str;
+}
+
+struct result {
+    std::string_view corpus;
+    std::size_t bytes;
+    std::size_t iterations;
+    double seconds_per_iteration;
+    std::size_t tokens;
+    hycc::support::allocation_counts allocations;
+};
+
+[[nodiscard]] auto measure(const std::string_view corpus, std::u8string&& str) -> result {
+    using clock = std::chrono::steady_clock;
+    constexpr auto min_duration = std::chrono::milliseconds{ 200 };
+
+    const auto bytes = str.size();
+    auto source      = hycc::source_code{ std::move(str) };
+
+    // Allocations are counted from a separate run, so reading the counters is not timed.
+    const auto before = hycc::support::allocations_so_far();
+    const auto tokens = hycc::tokenize(source).size();
+    const auto after  = hycc::support::allocations_so_far();
+
+    auto iterations  = 0uz;
+    const auto start = clock::now();
+    auto elapsed     = clock::duration{};
+    do {
+        [[maybe_unused]] const auto buffer = hycc::tokenize(source);
+        ++iterations;
+        elapsed = clock::now() - start;
+    } while (elapsed < min_duration);
+
+    return { .corpus                = corpus,
+             .bytes                 = bytes,
+             .iterations            = iterations,
+             .seconds_per_iteration = std::chrono::duration<double>(elapsed).count()
+                                      / static_cast<double>(iterations),
+             .tokens                = tokens,
+             .allocations           = { after.allocations - before.allocations,
+                                        after.bytes - before.bytes } };
+}
+
+[[nodiscard]] auto to_json(const result& r) -> std::string {
+    const auto mb = static_cast<double>(r.bytes) / 1e6;
+    return std::format(R"({{"corpus": "{}", "bytes": {}, "iterations": {}, )"
+                       R"("seconds_per_iteration": {:.9f}, "mb_per_second": {:.3f}, )"
+                       R"("tokens": {}, "tokens_per_second": {:.0f}, )"
+                       R"("allocations": {}, "allocated_bytes": {}}})",
+                       r.corpus,
+                       r.bytes,
+                       r.iterations,
+                       r.seconds_per_iteration,
+                       mb / r.seconds_per_iteration,
+                       r.tokens,
+                       static_cast<double>(r.tokens) / r.seconds_per_iteration,
+                       r.allocations.allocations,
+                       r.allocations.bytes);
+}
+
+} // namespace
+
+int main(const int argc, const char* const argv[]) {
+    auto max_size = 100uz * 1000uz * 1000uz;
+    if (argc > 1) max_size = std::stoull(argv[1]);
+
+    const auto corpora = std::vector<std::pair<std::string_view, corpus_generator>>{
+        { "identifier_heavy", identifier_heavy }, { "operator_heavy", operator_heavy },
+        { "block_comments", block_comments },     { "long_literals", long_literals },
+        { "nested_braces", nested_braces },
+    };
+
+    auto results = std::vector<std::string>{};
+    for (const auto& [name, generator] : corpora) {
+        for (auto size = 1000uz; size <= max_size; size *= 10) {
+            results.push_back(to_json(measure(name, generate(generator, size))));
+        }
+    }
+
+    std::cout << "{\"benchmarks\": [\n";
+    for (auto i = 0uz; i < results.size(); ++i) {
+        std::cout << "    " << results[i] << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    std::cout << "]}\n";
+}
@@ -3,7 +3,9 @@
 #include <algorithm>
 #include <array>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <type_traits>
@@ -38,6 +40,7 @@ class statement_scope;
 class namespace_scope;
 class function_scope;
 class class_scope;
+class error_node;
 using ordered_property = std::variant<nested_scope,
                                       if_statement_node,
                                       for_loop_statement_node,
@@ -46,7 +49,8 @@ using ordered_property = std::variant<nested_scope,
                                       return_statement_node,
                                       namespace_decleration_node,
                                       expression_node,
-                                      data_decleration_node>;
+                                      data_decleration_node,
+                                      error_node>;
 
 using unordered_property = std::variant<function_decleration_node, class_decleration_node>;
 
@@ -60,19 +64,24 @@ using identifier_unit = std::variant<scope_resolution_operator, token>;
 
 class identifier_node {
     static constexpr auto identifier_pattern = std::array{ token_type::identifier };
+    static constexpr auto whitespace_pattern = std::array{ token_type::whitespace };
 
     std::vector<identifier_unit> identifier_units_ = {};
+    /// Buffer of the identifier tokens, used to compare their text.
+    const token_buffer* buffer_ = nullptr;
 
     constexpr void match_single_pattern_until_end(parser_t& parser);
 
   public:
-    constexpr void push(parser_t& parser) {
+    constexpr auto push(parser_t& parser) -> parse_result {
+        buffer_ = &parser.buffer();
+
         // Ignore potential whitespace in the beginning.
-        [[maybe_unused]] auto _ =
-            parser.match_and_consume(std::vector{ token_type::whitespace }, false);
+        [[maybe_unused]] auto _ = parser.match_and_consume(whitespace_pattern, false);
 
         match_single_pattern_until_end(parser);
-        if (identifier_units_.empty()) parser.throw_syntax_error();
+        if (identifier_units_.empty()) return parser.report_syntax_error();
+        return {};
     }
 
     [[nodiscard]] friend constexpr bool operator==(const identifier_node& lhs,
@@ -81,7 +90,7 @@ class identifier_node {
         namespace rv = std::ranges::views;
         return std::ranges::all_of(
             rv::zip(lhs.identifier_units_, rhs.identifier_units_)
-                | rv::transform([](const auto& x) {
+                | rv::transform([&](const auto& x) {
                       const auto l = std::get<0>(x);
                       const auto r = std::get<1>(x);
                       if (std::holds_alternative<scope_resolution_operator>(l)
@@ -96,7 +105,9 @@ class identifier_node {
                       // Both are tokens and assumend to be a identifiers.
                       const auto l_t = std::get<token>(l);
                       const auto r_t = std::get<token>(r);
-                      return l_t.sv_in_source == r_t.sv_in_source;
+                      // Symbols are comparable only within the same buffer.
+                      if (lhs.buffer_ == rhs.buffer_) return l_t.symbol == r_t.symbol;
+                      return lhs.buffer_->sv(l_t) == rhs.buffer_->sv(r_t);
                   }),
             std::identity{});
     }
@@ -106,6 +117,13 @@ class identifier_node {
     static constexpr auto scope_resolution_operator_pattern =
         std::array{ token_pattern{ token_type::semantic_scope_operator, u8":" },
                     token_pattern{ token_type::semantic_scope_operator, u8":" } };
+    /// Scope resolution operator tokenized with operator_mode::maximal_munch.
+    static constexpr auto munched_scope_resolution_operator_pattern =
+        std::array{ token_pattern{ token_type::semantic_scope_operator, u8"::" } };
+    static constexpr auto identifier_unit_patterns =
+        pattern_set<scope_resolution_operator_pattern,
+                    munched_scope_resolution_operator_pattern,
+                    identifier_pattern>{};
     ////////////////////////////////////////////////////////////////////////////////////////////////
 };
 
@@ -117,10 +135,12 @@ class function_argument_node {
     struct function_argument;
     std::vector<function_argument> args_{};
 
-    constexpr void match_all_patterns_until_end(parser_t& parser);
+    constexpr auto match_all_patterns_until_end(parser_t& parser) -> parse_result;
 
   public:
-    constexpr void push(parser_t& parser) { match_all_patterns_until_end(parser); }
+    constexpr auto push(parser_t& parser) -> parse_result {
+        return match_all_patterns_until_end(parser);
+    }
 
     [[nodiscard]] constexpr auto get_args(this auto&&) -> std::span<function_argument const>;
 
@@ -138,6 +158,13 @@ class function_argument_node {
         std::array{ token_pattern{ token_type::identifier, u8"copy" } };
     static constexpr auto forward_pattern =
         std::array{ token_pattern{ token_type::identifier, u8"forward" } };
+    /// In the order of passing_type.
+    static constexpr auto passing_type_patterns = pattern_set<in_pattern,
+                                                              inout_pattern,
+                                                              out_pattern,
+                                                              move_pattern,
+                                                              copy_pattern,
+                                                              forward_pattern>{};
     static constexpr auto argument_identifier_pattern = std::array{ token_type::identifier };
     static constexpr auto type_separator_pattern =
         std::array{ token_pattern{ token_type::semantic_scope_operator, u8":" } };
@@ -159,10 +186,10 @@ class type_node {
     std::unique_ptr<type_node> pointed_type_{};
     std::optional<identifier_node> regular_type_{};
 
-    constexpr void match_all_patterns(parser_t& parser);
+    constexpr auto match_all_patterns(parser_t& parser) -> parse_result;
 
   public:
-    constexpr void push(parser_t& parser) { match_all_patterns(parser); }
+    constexpr auto push(parser_t& parser) -> parse_result { return match_all_patterns(parser); }
     [[nodiscard]] constexpr bool is_function(this auto&& self) noexcept {
         return static_cast<bool>(self.function_);
     }
@@ -194,10 +221,17 @@ class type_node {
     static constexpr auto function_return_type_separator_pattern =
         std::array{ token_pattern{ token_type::operator_token, u8"-" },
                     token_pattern{ token_type::operator_token, u8">" } };
+    /// Function return type separator tokenized with operator_mode::maximal_munch.
+    static constexpr auto munched_function_return_type_separator_pattern =
+        std::array{ token_pattern{ token_type::operator_token, u8"->" } };
+    static constexpr auto function_return_type_separator_patterns =
+        pattern_set<function_return_type_separator_pattern,
+                    munched_function_return_type_separator_pattern>{};
     static constexpr auto const_pattern =
         std::array{ token_pattern{ token_type::identifier, u8"const" } };
     static constexpr auto pointer_pattern =
         std::array{ token_pattern{ token_type::operator_token, u8"*" } };
+    static constexpr auto whitespace_pattern = std::array{ token_type::whitespace };
     ////////////////////////////////////////////////////////////////////////////////////////////////
 };
 
@@ -223,17 +257,42 @@ class function_decleration_node {};
 class namespace_decleration_node {};
 class data_decleration_node {};
 class decleration_parsing_node {};
+class action_stack;
+
 class scope_node {
-    constexpr void match_single_pattern_until_end(parser_t& parser);
+    friend class action_stack;
+
+    /// What action_stack does after an action of a scope.
+    struct action_result {
+        /// Nested scope to be pushed on top of the stack.
+        scope_node* nested = nullptr;
+        /// Result of the scope, if it has ended and is popped from the stack.
+        std::optional<parse_result> end{};
+    };
+
+    /// Matches a single pattern, which is one action of the scope.
+    constexpr auto match_single_pattern(parser_t& parser) -> action_result;
     std::vector<ordered_property> ordered_property_;
     bool is_global_scope_ = false;
 
   public:
+    constexpr scope_node() = default;
+    constexpr scope_node(const scope_node& other);
+    constexpr scope_node(scope_node&&) = default;
+    constexpr scope_node& operator=(const scope_node& other);
+    constexpr scope_node& operator=(scope_node&&) = default;
+    constexpr ~scope_node();
+
     constexpr void mark_as_global_scope() noexcept { is_global_scope_ = true; }
     [[nodiscard]] constexpr bool is_global_scope(this auto&& self) noexcept {
         return self.is_global_scope_;
     }
-    constexpr void push(parser_t& parser) { match_single_pattern_until_end(parser); }
+    /// Parses the scope with action_stack, so nested scopes do not recurse.
+    ///
+    /// In error_mode::recover syntax errors are stored as error_node
+    /// and parsing continues after parser_t::synchronize.
+    /// Fails only if tokens end before the end of the scope.
+    constexpr auto push(parser_t& parser) -> parse_result;
     [[nodiscard]] constexpr decltype(auto) get_ordered_property(this auto&& self);
 
   private:
@@ -242,6 +301,7 @@ class scope_node {
         std::array{ token_pattern{ token_type::semantic_scope_operator, u8"{" } };
     static constexpr auto end_of_scope =
         std::array{ token_pattern{ token_type::semantic_scope_operator, u8"}" } };
+    static constexpr auto scope_patterns = pattern_set<nested_scope_pat, end_of_scope>{};
     ////////////////////////////////////////////////////////////////////////////////////////////////
 };
 class if_statement_node {};
@@ -256,53 +316,91 @@ class namespace_scope : public scope_node {};
 class function_scope : public scope_node {};
 class class_scope : public scope_node {};
 
+/// Parses scopes by executing their actions from an explicit stack of the scopes,
+/// see docs/sphinx/parser.rst, so that depth of nesting is limited only by the heap.
+///
+/// Parsing can be paused after a number of actions and resumed by running it again.
+class action_stack {
+    std::vector<scope_node*> stack_;
+    std::optional<parse_result> result_{};
+
+  public:
+    /// Pushes \p root, which has to outlive the parsing.
+    [[nodiscard]] constexpr explicit action_stack(scope_node& root) : stack_{ &root } {}
+
+    /// Executes at most \p max_actions actions.
+    ///
+    /// Returns result of the root scope, or nullopt if paused before the root scope ended.
+    constexpr auto run(parser_t& parser,
+                       const std::size_t max_actions = std::numeric_limits<std::size_t>::max())
+        -> std::optional<parse_result> {
+        for (auto n = 0uz; n < max_actions and not stack_.empty(); ++n) {
+            auto action = stack_.back()->match_single_pattern(parser);
+            if (action.nested) {
+                stack_.push_back(action.nested);
+                continue;
+            }
+            if (not action.end) continue;
+
+            stack_.pop_back();
+            // Nested scope has recovered from its errors, unless the tokens ended,
+            // in which case all scopes below it end with the same error.
+            if (not action.end.value()) stack_.clear();
+            if (stack_.empty()) result_ = std::move(action.end);
+        }
+        return result_;
+    }
+
+    /// Number of scopes being parsed.
+    [[nodiscard]] constexpr auto depth() const noexcept -> std::size_t { return stack_.size(); }
+};
+
+/// Place of a syntax error in partial AST parsed in error_mode::recover.
+class error_node {
+    syntax_diagnostic diagnostic_;
+
+  public:
+    [[nodiscard]] constexpr explicit error_node(const syntax_diagnostic& diagnostic)
+        : diagnostic_{ diagnostic } {}
+
+    [[nodiscard]] constexpr auto diagnostic() const noexcept -> const syntax_diagnostic& {
+        return diagnostic_;
+    }
+};
+
 // Now that all classes are fully defined we can use them in members.
 
 constexpr void identifier_node::match_single_pattern_until_end(parser_t& parser) {
     auto stop_signal = false;
     while (not stop_signal) {
-        auto matched = decltype(parser.match_and_consume(scope_resolution_operator_pattern)){};
-        if ((matched = parser.match_and_consume(scope_resolution_operator_pattern, false))) {
-            identifier_units_.push_back(scope_resolution_operator{});
-        } else if ((matched = parser.match_and_consume(identifier_pattern, false))) {
-            identifier_units_.push_back(matched.value().front());
-        } else {
+        const auto matched = parser.match_and_consume(identifier_unit_patterns, false);
+        if (not matched) {
             stop_signal = true;
+        } else if (const auto& t = matched->tokens.front(); t.type == token_type::identifier) {
+            identifier_units_.push_back(t);
+        } else {
+            identifier_units_.push_back(scope_resolution_operator{});
         }
     }
 }
 
-constexpr void function_argument_node::match_all_patterns_until_end(parser_t& parser) {
+constexpr auto function_argument_node::match_all_patterns_until_end(parser_t& parser)
+    -> parse_result {
     while (true) {
-        const auto passing_type_v = [&] {
-            auto passing_type_v = passing_type::in;
-            auto matched        = parser_t::matched_type{};
-            if ((matched = parser.match_and_consume(in_pattern))) {
-                passing_type_v = passing_type::in;
-            } else if ((matched = parser.match_and_consume(inout_pattern))) {
-                passing_type_v = passing_type::inout;
-            } else if ((matched = parser.match_and_consume(out_pattern))) {
-                passing_type_v = passing_type::out;
-            } else if ((matched = parser.match_and_consume(move_pattern))) {
-                passing_type_v = passing_type::move;
-            } else if ((matched = parser.match_and_consume(copy_pattern))) {
-                passing_type_v = passing_type::copy;
-            } else if ((matched = parser.match_and_consume(forward_pattern))) {
-                passing_type_v = passing_type::forward;
-            }
-            return passing_type_v;
-        }();
+        const auto passing_type_v =
+            parser.match_and_consume(passing_type_patterns)
+                .transform([](const auto& x) { return static_cast<passing_type>(x.index); })
+                .value_or(passing_type::in);
 
         const auto identifier =
             parser.match_and_consume(argument_identifier_pattern).transform([](const auto& x) {
                 return x.front();
             });
 
-        auto type = parser.match_and_consume(type_separator_pattern).transform([&](const auto&) {
-            auto t = type_node{};
-            t.push(parser);
-            return t;
-        });
+        auto type = std::optional<type_node>{};
+        if (parser.match_and_consume(type_separator_pattern)) {
+            if (const auto pushed = type.emplace().push(parser); not pushed) return pushed;
+        }
 
         if (identifier) {
             args_.push_back(
@@ -313,58 +411,117 @@ constexpr void function_argument_node::match_all_patterns_until_end(parser_t& pa
         const auto end   = parser.match_and_consume(end_of_argument_pattern);
 
         if (end) {
-            if (comma) parser.throw_syntax_error();
-            break;
+            if (comma) return parser.report_syntax_error();
+            return {};
         }
-        if (not comma) parser.throw_syntax_error();
+        if (not comma) return parser.report_syntax_error();
     }
 }
 
-constexpr void type_node::match_all_patterns(parser_t& parser) {
+constexpr auto type_node::match_all_patterns(parser_t& parser) -> parse_result {
     auto matched = parser_t::matched_type{};
     if ((matched = parser.match_and_consume(function_arguments_pattern))) {
         function_ = std::make_unique<function_type>();
-        function_->args.push(parser);
+        if (const auto pushed = function_->args.push(parser); not pushed) return pushed;
 
         // Ignore potential leading whitespace.
-        [[maybe_unused]] const auto _ =
-            parser.match_and_consume(std::vector{ token_type::whitespace }, false);
+        [[maybe_unused]] const auto _ = parser.match_and_consume(whitespace_pattern, false);
 
-        if ((matched = parser.match_and_consume(function_return_type_separator_pattern, false))) {
+        if (parser.match_and_consume(function_return_type_separator_patterns, false)) {
             auto ret_type = type_node{};
-            ret_type.push(parser);
+            const auto pushed      = ret_type.push(parser);
             function_->return_type = std::move(ret_type);
-            return;
+            return pushed;
         } else
-            parser.throw_syntax_error();
+            return parser.report_syntax_error();
     }
     if ((matched = parser.match_and_consume(const_pattern))) { is_const_ = true; }
     if ((matched = parser.match_and_consume(pointer_pattern))) {
         pointed_type_ = std::make_unique<type_node>();
-        pointed_type_->push(parser);
+        return pointed_type_->push(parser);
     } else {
         regular_type_ = identifier_node{};
-        regular_type_.value().push(parser);
+        return regular_type_.value().push(parser);
     }
 }
 
-constexpr void scope_node::match_single_pattern_until_end(parser_t& parser) {
-    auto stop_signal = false;
-    while (not stop_signal) {
-        if (is_global_scope() and parser.all_parsed()) goto stop;
-        auto matched = decltype(parser.match_and_consume(nested_scope_pat)){};
-        if ((matched = parser.match_and_consume(nested_scope_pat))) {
-            auto scope = nested_scope{};
-            scope.push(parser);
-            ordered_property_.push_back(scope);
-        } else if ((matched = parser.match_and_consume(end_of_scope))) {
-            if (is_global_scope()) parser.throw_syntax_error();
-            stop_signal = true;
-        } else {
-            parser.throw_syntax_error();
+constexpr scope_node::scope_node(const scope_node& other)
+    : is_global_scope_{ other.is_global_scope_ } {
+    // Nested scopes are copied from a worklist instead of recursively,
+    // so that deeply nested scopes do not overflow the stack.
+    auto pending = std::vector<std::pair<scope_node*, const scope_node*>>{ { this, &other } };
+    while (not pending.empty()) {
+        const auto [to, from] = pending.back();
+        pending.pop_back();
+
+        // Reserved, so that nested scopes waiting in pending are not moved.
+        to->ordered_property_.reserve(from->ordered_property_.size());
+        for (const auto& property : from->ordered_property_) {
+            if (const auto* const n = std::get_if<nested_scope>(&property)) {
+                auto& scope            = std::get<nested_scope>(
+                    to->ordered_property_.emplace_back(std::in_place_type<nested_scope>));
+                scope.is_global_scope_ = n->is_global_scope_;
+                pending.emplace_back(&scope, n);
+            } else {
+                to->ordered_property_.push_back(property);
+            }
+        }
+    }
+}
+
+constexpr scope_node& scope_node::operator=(const scope_node& other) {
+    if (this != &other) *this = scope_node{ other };
+    return *this;
+}
+
+constexpr scope_node::~scope_node() {
+    // Nested scopes are destroyed from a worklist instead of recursively,
+    // so that deeply nested scopes do not overflow the stack.
+    auto nested = std::vector<scope_node>{};
+    const auto take_nested = [&](scope_node& scope) {
+        for (auto& property : scope.ordered_property_) {
+            if (auto* const n = std::get_if<nested_scope>(&property)) {
+                nested.push_back(std::move(*n));
+            }
+        }
+    };
+
+    take_nested(*this);
+    while (not nested.empty()) {
+        auto scope = std::move(nested.back());
+        nested.pop_back();
+        take_nested(scope);
+    }
+}
+
+constexpr auto scope_node::push(parser_t& parser) -> parse_result {
+    return action_stack{ *this }.run(parser).value();
+}
+
+constexpr auto scope_node::match_single_pattern(parser_t& parser) -> action_result {
+    if (is_global_scope() and parser.all_parsed()) return { .end = parse_result{} };
+
+    auto error = parse_result{};
+    if (const auto matched = parser.match_and_consume(scope_patterns)) {
+        // Alternatives of scope_patterns are nested_scope_pat and end_of_scope.
+        if (matched->index == 0) {
+            // Nested scope is parsed in place, as this scope is not resumed before it ends.
+            auto& scope = ordered_property_.emplace_back(std::in_place_type<nested_scope>);
+            return { .nested = &std::get<nested_scope>(scope) };
         }
+
+        if (not is_global_scope()) return { .end = parse_result{} };
+        error = parser.report_syntax_error(syntax_diagnostic{ matched->tokens.front() });
+    } else {
+        error = parser.report_syntax_error();
+        // Unexpected token was not consumed, so skip it and the rest of its statement.
+        [[maybe_unused]] const auto _ = parser.synchronize();
     }
-stop:
+
+    ordered_property_.push_back(error_node{ error.error() });
+    // Tokens ended before the end of the scope.
+    if (not error.error().at) return { .end = error };
+    return {};
 }
 [[nodiscard]] constexpr decltype(auto) scope_node::get_ordered_property(this auto&& self) {
     return std::span{ self.ordered_property_ };
@@ -0,0 +1,363 @@
+#pragma once
+
+/// @file Character classification used by the tokenizer.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__AVX2__) or defined(__SSE2__)
+#    include <immintrin.h>
+#endif
+
+namespace hycc {
+
+enum class char_class : std::uint8_t {
+    whitespace,
+    id,
+    integer,
+    literal_scope_operator,
+    semantic_scope_operator,
+    operator_unit,
+    other
+};
+
+/// Character class of every code unit, indexed by the code unit.
+///
+/// See docs/sphinx/tokenizer.rst for the definition of the classes.
+inline constexpr auto char_class_table = [] {
+    using enum char_class;
+
+    auto table = std::array<char_class, 256>{};
+    table.fill(other);
+
+    auto set = [&](const std::u8string_view chars, const char_class c_class) {
+        for (const auto c : chars) table[c] = c_class;
+    };
+    auto set_range = [&](const char8_t first, const char8_t last, const char_class c_class) {
+        for (auto c = static_cast<std::size_t>(first); c <= static_cast<std::size_t>(last); ++c)
+            table[c] = c_class;
+    };
+
+    set(u8"\t\v\f \n", whitespace);
+    set_range(u8'A', u8'Z', id);
+    set(u8"_", id);
+    set_range(u8'a', u8'z', id);
+    set_range(u8'0', u8'9', integer);
+    set(u8"\"'`", literal_scope_operator);
+    set(u8"(),.:;[]{}", semantic_scope_operator);
+    set(u8"!#$%&*+-/<=>?@\\^|~", operator_unit);
+
+    return table;
+}();
+
+[[nodiscard]] constexpr auto classify_char(const char8_t c) -> char_class {
+    return char_class_table[c];
+}
+
+/// Runs of characters which form the bulk of tokens.
+enum class char_run {
+    /// Characters of class whitespace.
+    whitespace,
+    /// Characters of class integer.
+    integer,
+    /// Characters of class id or integer, i.e. the characters after the first one of identifier.
+    id_continuation,
+    /// Characters of class other, which form error tokens.
+    other
+};
+
+[[nodiscard]] constexpr bool is_part_of_run(const char_run run, const char8_t c) {
+    const auto c_class = classify_char(c);
+    switch (run) {
+        case char_run::whitespace: return c_class == char_class::whitespace;
+        case char_run::integer: return c_class == char_class::integer;
+        case char_run::id_continuation:
+            return c_class == char_class::id or c_class == char_class::integer;
+        case char_run::other: return c_class == char_class::other;
+    }
+    return false;
+}
+
+namespace detail {
+
+[[nodiscard]] constexpr auto scalar_run_length(const char_run run, const std::u8string_view str)
+    -> std::size_t {
+    auto n = 0uz;
+    while (n < str.size() and is_part_of_run(run, str[n])) ++n;
+    return n;
+}
+
+#if defined(__AVX2__)
+
+/// Bit i is set if i:th byte of \p x is part of \p run.
+[[nodiscard]] inline auto run_mask(const char_run run, const __m256i x) -> std::uint32_t {
+    // Unsigned x <= bound for each byte.
+    auto less_or_equal = [](const __m256i y, const char bound) {
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(y, _mm256_set1_epi8(bound)), y);
+    };
+    auto in_range = [&](const __m256i y, const char first, const char last) {
+        return less_or_equal(_mm256_sub_epi8(y, _mm256_set1_epi8(first)),
+                             static_cast<char>(last - first));
+    };
+
+    const auto digits = in_range(x, '0', '9');
+    auto in_run       = __m256i{};
+    switch (run) {
+        case char_run::whitespace:
+            in_run = _mm256_or_si256(in_range(x, '\t', '\f'),
+                                     _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+            break;
+        case char_run::integer: in_run = digits; break;
+        case char_run::id_continuation: {
+            // Setting 0x20 bit maps upper case letters to lower case letters
+            // and no other character to lower case letters.
+            const auto letters = in_range(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), 'a', 'z');
+            const auto low_line = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_'));
+            in_run              = _mm256_or_si256(_mm256_or_si256(letters, low_line), digits);
+        } break;
+        case char_run::other: {
+            // Every printable ASCII character has a class, so other is control characters,
+            // except whitespace, delete and the code units from 0x80 up, which are negative
+            // in the signed comparison.
+            const auto below_space = _mm256_cmpgt_epi8(_mm256_set1_epi8(' '), x);
+            const auto whitespace  = in_range(x, '\t', '\f');
+            const auto del         = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x7F));
+            in_run = _mm256_or_si256(_mm256_andnot_si256(whitespace, below_space), del);
+        } break;
+    }
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(in_run));
+}
+
+inline constexpr auto simd_width = 32uz;
+
+[[nodiscard]] inline auto simd_run_length(const char_run run, const std::u8string_view str)
+    -> std::size_t {
+    auto n = 0uz;
+    for (; n + simd_width <= str.size(); n += simd_width) {
+        const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + n));
+        const auto not_in_run = ~run_mask(run, x);
+        if (not_in_run) return n + static_cast<std::size_t>(__builtin_ctz(not_in_run));
+    }
+    return n + scalar_run_length(run, str.substr(n));
+}
+
+#elif defined(__SSE2__)
+
+/// Bit i is set if i:th byte of \p x is part of \p run.
+[[nodiscard]] inline auto run_mask(const char_run run, const __m128i x) -> std::uint32_t {
+    // Unsigned x <= bound for each byte.
+    auto less_or_equal = [](const __m128i y, const char bound) {
+        return _mm_cmpeq_epi8(_mm_min_epu8(y, _mm_set1_epi8(bound)), y);
+    };
+    auto in_range = [&](const __m128i y, const char first, const char last) {
+        return less_or_equal(_mm_sub_epi8(y, _mm_set1_epi8(first)),
+                             static_cast<char>(last - first));
+    };
+
+    const auto digits = in_range(x, '0', '9');
+    auto in_run       = __m128i{};
+    switch (run) {
+        case char_run::whitespace:
+            in_run = _mm_or_si128(in_range(x, '\t', '\f'), _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+            break;
+        case char_run::integer: in_run = digits; break;
+        case char_run::id_continuation: {
+            // Setting 0x20 bit maps upper case letters to lower case letters
+            // and no other character to lower case letters.
+            const auto letters  = in_range(_mm_or_si128(x, _mm_set1_epi8(0x20)), 'a', 'z');
+            const auto low_line = _mm_cmpeq_epi8(x, _mm_set1_epi8('_'));
+            in_run              = _mm_or_si128(_mm_or_si128(letters, low_line), digits);
+        } break;
+        case char_run::other: {
+            // Every printable ASCII character has a class, so other is control characters,
+            // except whitespace, delete and the code units from 0x80 up, which are negative
+            // in the signed comparison.
+            const auto below_space = _mm_cmpgt_epi8(_mm_set1_epi8(' '), x);
+            const auto whitespace  = in_range(x, '\t', '\f');
+            const auto del         = _mm_cmpeq_epi8(x, _mm_set1_epi8(0x7F));
+            in_run                 = _mm_or_si128(_mm_andnot_si128(whitespace, below_space), del);
+        } break;
+    }
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(in_run));
+}
+
+inline constexpr auto simd_width = 16uz;
+
+[[nodiscard]] inline auto simd_run_length(const char_run run, const std::u8string_view str)
+    -> std::size_t {
+    auto n = 0uz;
+    for (; n + simd_width <= str.size(); n += simd_width) {
+        const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + n));
+        // Only lowest 16 bits are used by the mask.
+        const auto not_in_run = ~run_mask(run, x) & 0xFFFFu;
+        if (not_in_run) return n + static_cast<std::size_t>(__builtin_ctz(not_in_run));
+    }
+    return n + scalar_run_length(run, str.substr(n));
+}
+
+#endif
+
+[[nodiscard]] constexpr auto scalar_find_either(const std::u8string_view str,
+                                                const char8_t a,
+                                                const char8_t b) -> std::size_t {
+    auto n = 0uz;
+    while (n < str.size() and str[n] != a and str[n] != b) ++n;
+    return n;
+}
+
+#if defined(__AVX2__)
+
+[[nodiscard]] inline auto simd_find_either(const std::u8string_view str,
+                                           const char8_t a,
+                                           const char8_t b) -> std::size_t {
+    const auto as = _mm256_set1_epi8(static_cast<char>(a));
+    const auto bs = _mm256_set1_epi8(static_cast<char>(b));
+    auto n        = 0uz;
+    for (; n + simd_width <= str.size(); n += simd_width) {
+        const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + n));
+        const auto matches = _mm256_or_si256(_mm256_cmpeq_epi8(x, as), _mm256_cmpeq_epi8(x, bs));
+        const auto found   = _mm256_movemask_epi8(matches);
+        if (found) return n + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(found)));
+    }
+    return n + scalar_find_either(str.substr(n), a, b);
+}
+
+#elif defined(__SSE2__)
+
+[[nodiscard]] inline auto simd_find_either(const std::u8string_view str,
+                                           const char8_t a,
+                                           const char8_t b) -> std::size_t {
+    const auto as = _mm_set1_epi8(static_cast<char>(a));
+    const auto bs = _mm_set1_epi8(static_cast<char>(b));
+    auto n        = 0uz;
+    for (; n + simd_width <= str.size(); n += simd_width) {
+        const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + n));
+        const auto matches = _mm_or_si128(_mm_cmpeq_epi8(x, as), _mm_cmpeq_epi8(x, bs));
+        const auto found   = _mm_movemask_epi8(matches);
+        if (found) return n + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(found)));
+    }
+    return n + scalar_find_either(str.substr(n), a, b);
+}
+
+#endif
+
+[[nodiscard]] constexpr auto scalar_ascii_length(const std::u8string_view str) -> std::size_t {
+    auto n = 0uz;
+    while (n < str.size() and str[n] < 0x80) ++n;
+    return n;
+}
+
+#if defined(__AVX2__)
+
+[[nodiscard]] inline auto simd_ascii_length(const std::u8string_view str) -> std::size_t {
+    auto n = 0uz;
+    for (; n + simd_width <= str.size(); n += simd_width) {
+        const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + n));
+        // Highest bit of every non-ASCII code unit is set.
+        const auto non_ascii = static_cast<unsigned>(_mm256_movemask_epi8(x));
+        if (non_ascii) return n + static_cast<std::size_t>(__builtin_ctz(non_ascii));
+    }
+    return n + scalar_ascii_length(str.substr(n));
+}
+
+#elif defined(__SSE2__)
+
+[[nodiscard]] inline auto simd_ascii_length(const std::u8string_view str) -> std::size_t {
+    auto n = 0uz;
+    for (; n + simd_width <= str.size(); n += simd_width) {
+        const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + n));
+        // Highest bit of every non-ASCII code unit is set.
+        const auto non_ascii = static_cast<unsigned>(_mm_movemask_epi8(x));
+        if (non_ascii) return n + static_cast<std::size_t>(__builtin_ctz(non_ascii));
+    }
+    return n + scalar_ascii_length(str.substr(n));
+}
+
+#endif
+
+/// Length of the ASCII code units at the beginning of \p str.
+[[nodiscard]] constexpr auto ascii_length(const std::u8string_view str) -> std::size_t {
+#if defined(__AVX2__) or defined(__SSE2__)
+    if !consteval { return simd_ascii_length(str); }
+#endif
+    return scalar_ascii_length(str);
+}
+
+} // namespace detail
+
+/// Length of the run of \p run at the beginning of \p str.
+///
+/// At runtime scans 16 (SSE2) or 32 (AVX2) characters at the time if available.
+[[nodiscard]] constexpr auto run_length(const char_run run, const std::u8string_view str)
+    -> std::size_t {
+#if defined(__AVX2__) or defined(__SSE2__)
+    if !consteval { return detail::simd_run_length(run, str); }
+#endif
+    return detail::scalar_run_length(run, str);
+}
+
+/// Index of the first \p a or \p b in \p str, or str.size() if there is neither.
+///
+/// At runtime compares 16 (SSE2) or 32 (AVX2) characters at the time if available,
+/// like memchr does for a single character.
+[[nodiscard]] constexpr auto find_either(const std::u8string_view str,
+                                         const char8_t a,
+                                         const char8_t b) -> std::size_t {
+#if defined(__AVX2__) or defined(__SSE2__)
+    if !consteval { return detail::simd_find_either(str, a, b); }
+#endif
+    return detail::scalar_find_either(str, a, b);
+}
+
+/// Length of the UTF-8 encoded character at the beginning of \p str, or 0 if it is not valid.
+///
+/// Overlong encodings, surrogates and code points above U+10FFFF are not valid.
+[[nodiscard]] constexpr auto utf8_sequence_length(const std::u8string_view str) -> std::size_t {
+    if (str.empty()) return 0;
+    const auto lead = str.front();
+    if (lead < 0x80) return 1;
+
+    // Range of the second code unit, which excludes the invalid code points,
+    // and the length of the sequence.
+    auto second_min = char8_t{ 0x80 };
+    auto second_max = char8_t{ 0xBF };
+    auto length     = 0uz;
+    if (lead >= 0xC2 and lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 and lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) second_min = 0xA0;
+        if (lead == 0xED) second_max = 0x9F;
+    } else if (lead >= 0xF0 and lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) second_min = 0x90;
+        if (lead == 0xF4) second_max = 0x8F;
+    } else {
+        return 0;
+    }
+
+    if (str.size() < length or str[1] < second_min or str[1] > second_max) return 0;
+    for (auto i = 2uz; i < length; ++i) {
+        if (str[i] < 0x80 or str[i] > 0xBF) return 0;
+    }
+    return length;
+}
+
+/// Offset of the first code unit of \p str, which does not begin a valid UTF-8 sequence,
+/// or str.size() if \p str is valid UTF-8.
+///
+/// At runtime ASCII is skipped 16 (SSE2) or 32 (AVX2) characters at the time if available.
+[[nodiscard]] constexpr auto find_invalid_utf8(const std::u8string_view str) -> std::size_t {
+    auto n = 0uz;
+    while (true) {
+        n += detail::ascii_length(str.substr(n));
+        if (n == str.size()) return n;
+        const auto length = utf8_sequence_length(str.substr(n));
+        if (length == 0) return n;
+        n += length;
+    }
+}
+
+} // namespace hycc
@@ -0,0 +1,278 @@
+#pragma once
+
+/// @file Tokenization of edited source code, which reuses the tokens from before the edit.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "hycc/tokenizer.hpp"
+
+namespace hycc {
+
+/// Replacement of \p removed code units at \p offset with \p inserted code units.
+struct text_edit {
+    std::size_t offset;
+    std::size_t removed;
+    std::size_t inserted;
+};
+
+namespace detail {
+
+/// Tokenizer decides that a token has ended by looking at most this many code units,
+/// starting from the end of the token, as line comment continues if // is after it
+/// and the longest multi character operator is three code units.
+inline constexpr auto tokenizer_lookahead = 2uz;
+
+/// Size of the first window of source code tokenized again after the edit.
+inline constexpr auto initial_retokenize_window = 256uz;
+
+[[nodiscard]] constexpr auto end_of(const token& t) -> std::size_t {
+    return std::size_t{ t.offset } + t.length;
+}
+
+[[nodiscard]] constexpr bool is_trivia(const token& t) {
+    return t.type == token_type::whitespace or t.type == token_type::comment;
+}
+
+/// Token or trivia of \p pieces which begins at \p offset.
+[[nodiscard]] constexpr auto piece_at(const std::span<token const> pieces,
+                                      const std::size_t offset) -> const token* {
+    const auto it = std::ranges::lower_bound(pieces, offset, {}, [](const token& t) {
+        return std::size_t{ t.offset };
+    });
+    if (it == pieces.end() or it->offset != offset) return nullptr;
+    return &*it;
+}
+
+/// Range of pieces replaced by retokenize.
+struct splice_range {
+    /// Offset, from which the edited source is tokenized again.
+    std::size_t restart;
+    /// Offset in the edited source, from which the pieces of the previous source are kept.
+    std::size_t sync;
+    /// Offset in the previous source, which corresponds to sync.
+    std::size_t old_sync;
+    /// Size of the edited source minus size of the previous source.
+    std::ptrdiff_t shift;
+};
+
+/// Replaces \p pieces, which begin in [restart, old_sync) of the previous source,
+/// with the \p new_pieces, which begin before sync of the edited source.
+/// Offsets of \p new_pieces are relative to restart, and \p adjust is applied to each of them.
+/// Pieces from old_sync onward are shifted to the edited source in place.
+///
+/// Returns index of the first shifted piece.
+template<typename Piece>
+constexpr auto splice(sstd::resource_vector<Piece>& pieces,
+                      const std::span<Piece const> new_pieces,
+                      const splice_range& range,
+                      auto&& adjust) -> std::size_t {
+    auto index_of = [&](const std::size_t offset) {
+        const auto it = std::ranges::partition_point(pieces, [&](const Piece& p) {
+            return p.offset < offset;
+        });
+        return static_cast<std::size_t>(it - pieces.begin());
+    };
+    const auto begin = index_of(range.restart);
+    const auto end   = index_of(range.old_sync);
+
+    for (auto& p : std::span{ pieces }.subspan(end)) {
+        p.offset = static_cast<std::uint32_t>(static_cast<std::ptrdiff_t>(p.offset) + range.shift);
+    }
+
+    const auto n = static_cast<std::size_t>(
+        std::ranges::find_if(new_pieces,
+                             [&](const Piece& p) { return range.restart + p.offset >= range.sync; })
+        - new_pieces.begin());
+    const auto at       = pieces.begin() + static_cast<std::ptrdiff_t>(begin);
+    const auto replaced = at + static_cast<std::ptrdiff_t>(end - begin);
+    if (n > end - begin) {
+        pieces.insert(replaced, n - (end - begin), Piece{});
+    } else {
+        pieces.erase(at + static_cast<std::ptrdiff_t>(n), replaced);
+    }
+
+    for (auto i = 0uz; i < n; ++i) {
+        auto& p = pieces[begin + i];
+        p       = new_pieces[i];
+        p.offset += static_cast<std::uint32_t>(range.restart);
+        adjust(p);
+    }
+    return begin + n;
+}
+
+/// Access to the storage of token_buffer, so that retokenize can edit it in place.
+struct token_buffer_access {
+    [[nodiscard]] static auto tokens(token_buffer& b) noexcept -> auto& { return b.tokens_; }
+    [[nodiscard]] static auto trivia(token_buffer& b) noexcept -> auto& { return b.trivia_; }
+    [[nodiscard]] static auto symbols(token_buffer& b) noexcept -> auto& { return b.symbols_; }
+    [[nodiscard]] static auto diagnostics(token_buffer& b) noexcept -> auto& {
+        return b.diagnostics_;
+    }
+    static void set_source(token_buffer& b, source_ownership source) {
+        b.source_ = std::move(source);
+    }
+
+    /// Copy of \p b, which storage is allocated from the memory resource of \p b.
+    [[nodiscard]] static auto copy(const token_buffer& b) -> token_buffer {
+        const auto resource = b.resource();
+        return { b.source_,
+                 { b.tokens_, resource },
+                 { b.trivia_, resource },
+                 b.mode_,
+                 symbol_table{ b.symbols_ },
+                 b.operators_,
+                 { b.diagnostics_, resource } };
+    }
+};
+
+} // namespace detail
+
+/// Tokenizes \p edited, which is the source code of \p previous after \p edit,
+/// giving the same tokens as tokenize(edited, previous.mode(), previous.operators()).
+///
+/// Tokenization restarts from the last token, which could not be affected by the edit,
+/// and stops when a token begins where a token of \p previous began after the edit.
+/// The rest of the tokens are the tokens of \p previous, which are not tokenized again,
+/// but their offsets are shifted by the edit.
+///
+/// An edit is not sub-linear: shifting takes time linear in the number of tokens after it,
+/// and building \p edited copies the whole source and indexes its lines.
+/// Only the tokenizing is limited to the surroundings of the edit, so an edit is several
+/// times faster than tokenize, which benchmarks/bench_retokenize.cpp checks.
+///
+/// Tokens of \p previous are edited in place, and identifiers are interned to its symbol table,
+/// so the symbol table may contain identifiers which were removed by the edit.
+///
+/// Throws std::invalid_argument if \p edit does not fit the sizes of the sources,
+/// in which case \p previous is not modified.
+[[nodiscard]] inline auto retokenize(token_buffer&& previous,
+                                     source_code& edited,
+                                     const text_edit& edit) -> token_buffer {
+    const auto old_size = previous.source_sv().size();
+    const auto source   = edited.sv();
+    if (edit.removed > old_size or edit.offset > old_size - edit.removed
+        or source.size() != old_size - edit.removed + edit.inserted) {
+        throw std::invalid_argument{ "Edit does not match the sizes of the sources!" };
+    }
+    if (source.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{ "Source code is too large to be tokenized!" };
+    }
+
+    const auto mode       = previous.mode();
+    const auto old_tokens = previous.tokens();
+    const auto old_trivia = previous.trivia();
+
+    // Tokens ending far enough before the edit are not affected by it.
+    auto restart                        = 0uz;
+    auto restart_preceded_by_whitespace = false;
+    for (const auto pieces : { old_tokens, old_trivia }) {
+        const auto unaffected = std::ranges::partition_point(pieces, [&](const token& t) {
+            return detail::end_of(t) + detail::tokenizer_lookahead <= edit.offset;
+        });
+        if (unaffected == pieces.begin()) continue;
+        const auto& last = *(unaffected - 1);
+        if (detail::end_of(last) > restart) {
+            restart                        = detail::end_of(last);
+            restart_preceded_by_whitespace = detail::is_trivia(last);
+        }
+    }
+
+    // Offset in edited source, from which on the text is the same as in the previous one.
+    const auto edit_end = edit.offset + edit.inserted;
+    auto old_offset_of  = [&](const std::size_t offset) {
+        return offset - edit.inserted + edit.removed;
+    };
+
+    auto window_end = std::min(source.size(), edit_end + detail::initial_retokenize_window);
+    for (;;) {
+        auto state =
+            run_tokenizer(source.substr(restart, window_end - restart), mode, previous.operators());
+        for (auto* pieces : { &state.tokens, &state.trivia }) {
+            if (not pieces->empty() and pieces->front().offset == 0)
+                pieces->front().preceded_by_whitespace = restart_preceded_by_whitespace;
+        }
+
+        // Tokens at the end of the window might be cut short, unless at the end of the source.
+        const auto whole_source = window_end == source.size();
+        auto is_synchronized    = [&](const token& t) {
+            const auto offset = restart + t.offset;
+            const auto known  = whole_source
+                                or offset + detail::tokenizer_lookahead <= window_end;
+            if (offset < edit_end or not known) return false;
+            return detail::piece_at(old_tokens, old_offset_of(offset)) != nullptr
+                   or detail::piece_at(old_trivia, old_offset_of(offset)) != nullptr;
+        };
+
+        // Tokens from synchronized offset onward are taken from previous.
+        auto sync                        = source.size();
+        auto sync_preceded_by_whitespace = false;
+        for (const auto* pieces : { &state.tokens, &state.trivia }) {
+            const auto it = std::ranges::find_if(*pieces, is_synchronized);
+            if (it != pieces->end() and restart + it->offset < sync) {
+                sync                        = restart + it->offset;
+                sync_preceded_by_whitespace = it->preceded_by_whitespace;
+            }
+        }
+
+        if (sync == source.size() and not whole_source) {
+            window_end = std::min(source.size(), restart + 2 * (window_end - restart));
+            continue;
+        }
+
+        using access     = detail::token_buffer_access;
+        auto& symbols    = access::symbols(previous);
+        auto new_symbols = std::vector<symbol_id>(state.symbols.size(), no_symbol);
+        auto symbol_of   = [&](token& t) {
+            if (t.symbol == no_symbol or t.symbol < first_identifier_id) return;
+            auto& new_id = new_symbols[t.symbol - first_identifier_id];
+            if (new_id == no_symbol) new_id = symbols.intern(state.symbols.name(t.symbol));
+            t.symbol = new_id;
+        };
+
+        const auto range = detail::splice_range{
+            .restart  = restart,
+            .sync     = sync,
+            .old_sync = old_offset_of(sync),
+            .shift    = static_cast<std::ptrdiff_t>(edit.inserted)
+                     - static_cast<std::ptrdiff_t>(edit.removed),
+        };
+        auto splice_pieces = [&](sstd::resource_vector<token>& pieces,
+                                 const std::span<token const> new_pieces) {
+            const auto shifted = detail::splice(pieces, new_pieces, range, symbol_of);
+            if (shifted < pieces.size() and pieces[shifted].offset == sync)
+                pieces[shifted].preceded_by_whitespace = sync_preceded_by_whitespace;
+        };
+        splice_pieces(access::tokens(previous), state.tokens);
+        splice_pieces(access::trivia(previous), state.trivia);
+        // Diagnostics are within the tokens, so they are spliced at the same offsets.
+        [[maybe_unused]] const auto _ =
+            detail::splice(access::diagnostics(previous),
+                           std::span<tokenizer_diagnostic const>{ state.diagnostics },
+                           range,
+                           [](tokenizer_diagnostic&) {});
+
+        access::set_source(previous, edited.get_ownership_of_code());
+        return std::move(previous);
+    }
+}
+
+/// Retokenizes a copy of \p previous, see retokenize above.
+///
+/// Copies the tokens and the symbol table of \p previous,
+/// so prefer passing \p previous as rvalue, if it is not needed after the edit.
+[[nodiscard]] inline auto retokenize(const token_buffer& previous,
+                                     source_code& edited,
+                                     const text_edit& edit) -> token_buffer {
+    return retokenize(detail::token_buffer_access::copy(previous), edited, edit);
+}
+
+} // namespace hycc
@@ -0,0 +1,98 @@
+#pragma once
+
+/// @file Mapping from byte offsets in source code to rows and columns.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__) or defined(__SSE2__)
+#    include <immintrin.h>
+#endif
+
+namespace hycc {
+
+/// Row and column of a character in source code.
+///
+/// Rows start from 0 and newline is the character at column 0 of a row.
+/// On first row there is "virtual newline", so its first character is on column 1.
+struct source_position {
+    std::size_t row;
+    std::size_t column;
+
+    [[nodiscard]] friend constexpr bool operator==(const source_position&,
+                                                   const source_position&) = default;
+};
+
+/// Offsets of every newline in some source code.
+///
+/// Built once per source code, so that tokenizer does not have to keep track of rows and columns.
+/// Positions are resolved on demand with binary search.
+class line_index {
+    std::vector<std::size_t> newline_offsets_{};
+
+    constexpr void scalar_scan(const std::u8string_view code, const std::size_t first) {
+        for (auto i = first; i < code.size(); ++i) {
+            if (code[i] == u8'\n') newline_offsets_.push_back(i);
+        }
+    }
+
+#if defined(__AVX2__)
+    void simd_scan(const std::u8string_view code) {
+        const auto newline = _mm256_set1_epi8('\n');
+        auto i             = 0uz;
+        for (; i + 32uz <= code.size(); i += 32uz) {
+            const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(code.data() + i));
+            const auto is_newline = _mm256_cmpeq_epi8(x, newline);
+            auto mask             = static_cast<std::uint32_t>(_mm256_movemask_epi8(is_newline));
+            for (; mask; mask &= mask - 1u) {
+                newline_offsets_.push_back(i + static_cast<std::size_t>(__builtin_ctz(mask)));
+            }
+        }
+        scalar_scan(code, i);
+    }
+#elif defined(__SSE2__)
+    void simd_scan(const std::u8string_view code) {
+        const auto newline = _mm_set1_epi8('\n');
+        auto i             = 0uz;
+        for (; i + 16uz <= code.size(); i += 16uz) {
+            const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(code.data() + i));
+            const auto is_newline = _mm_cmpeq_epi8(x, newline);
+            auto mask             = static_cast<std::uint32_t>(_mm_movemask_epi8(is_newline));
+            for (; mask; mask &= mask - 1u) {
+                newline_offsets_.push_back(i + static_cast<std::size_t>(__builtin_ctz(mask)));
+            }
+        }
+        scalar_scan(code, i);
+    }
+#endif
+
+  public:
+    [[nodiscard]] constexpr line_index() = default;
+    [[nodiscard]] constexpr explicit line_index(const std::u8string_view code) {
+#if defined(__AVX2__) or defined(__SSE2__)
+        if !consteval {
+            simd_scan(code);
+            return;
+        }
+#endif
+        scalar_scan(code, 0);
+    }
+
+    /// Row and column of character at \p offset.
+    [[nodiscard]] constexpr auto position_of(const std::size_t offset) const -> source_position {
+        // Number of newlines at or before the offset is the row.
+        const auto row_end = std::ranges::upper_bound(newline_offsets_, offset);
+        const auto row     = static_cast<std::size_t>(row_end - newline_offsets_.begin());
+        if (row == 0) return { 0, offset + 1 };
+        return { row, offset - newline_offsets_[row - 1] };
+    }
+
+    [[nodiscard]] constexpr auto rows() const noexcept -> std::size_t {
+        return newline_offsets_.size() + 1;
+    }
+};
+
+} // namespace hycc
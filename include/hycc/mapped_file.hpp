@@ -0,0 +1,79 @@
+#pragma once
+
+/// @file Read only memory mapping of a file.
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hycc {
+
+/// Whole file mapped to memory as read only, so it can be used without copying it.
+///
+/// File should not be modified while it is mapped.
+class mapped_file {
+    const char8_t* data_ = nullptr;
+    std::size_t size_    = 0;
+
+  public:
+    /// Throws std::system_error if the file can not be mapped,
+    /// which includes files that are not regular files, e.g. pipes and directories.
+    [[nodiscard]] explicit mapped_file(const std::filesystem::path& path) {
+        // Opening a pipe would block until it has a writer, so it is opened without blocking.
+        const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+        if (fd < 0) {
+            throw std::system_error{ errno, std::generic_category(), "open " + path.string() };
+        }
+
+        auto close_and_throw = [&](const std::string& what, const int error = errno) {
+            ::close(fd);
+            throw std::system_error{ error, std::generic_category(), what + " " + path.string() };
+        };
+
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) close_and_throw("fstat");
+        // Size of other kinds of files is not the size of their content.
+        if (not S_ISREG(info.st_mode)) close_and_throw("not a regular file", EINVAL);
+        size_ = static_cast<std::size_t>(info.st_size);
+
+        // Empty files can not be mapped.
+        if (size_ != 0) {
+            void* const mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) close_and_throw("mmap");
+            // Only advice, so failure is not an error.
+            ::madvise(mapping, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char8_t*>(mapping);
+        }
+
+        // Mapping stays valid after the file descriptor is closed.
+        ::close(fd);
+    }
+
+    mapped_file(const mapped_file&)            = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    [[nodiscard]] mapped_file(mapped_file&& that) noexcept
+        : data_{ std::exchange(that.data_, nullptr) },
+          size_{ std::exchange(that.size_, 0) } {}
+    mapped_file& operator=(mapped_file&& that) noexcept {
+        std::swap(data_, that.data_);
+        std::swap(size_, that.size_);
+        return *this;
+    }
+
+    ~mapped_file() {
+        if (data_ != nullptr) ::munmap(const_cast<char8_t*>(data_), size_);
+    }
+
+    [[nodiscard]] auto sv() const noexcept -> std::u8string_view { return { data_, size_ }; }
+};
+
+} // namespace hycc
@@ -0,0 +1,321 @@
+#pragma once
+
+/// @file Tokenization of a single source code on multiple threads.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "hycc/tokenizer.hpp"
+
+namespace hycc {
+
+namespace detail {
+
+/// Offsets where chunks of \p source begin, followed by the size of \p source.
+///
+/// Chunks begin right after a newline, so every chunk except the last ends with a newline.
+[[nodiscard]] inline auto chunk_boundaries(const std::u8string_view source,
+                                           const std::size_t chunk_count)
+    -> std::vector<std::size_t> {
+    auto boundaries = std::vector<std::size_t>{ 0 };
+    for (auto i = 1uz; i < chunk_count; ++i) {
+        const auto target = std::max(boundaries.back(), i * source.size() / chunk_count);
+        const auto newline = source.find(u8'\n', target);
+        if (newline == std::u8string_view::npos) break;
+        if (newline + 1 != boundaries.back()) boundaries.push_back(newline + 1);
+    }
+    if (boundaries.back() != source.size()) boundaries.push_back(source.size());
+    return boundaries;
+}
+
+/// Stitches tokens of consecutive chunks together,
+/// so that the result is the same as if the chunks were tokenized as one.
+///
+/// Tokens and trivia of the chunks have to be stored to a side table.
+class chunk_stitcher {
+    std::u8string_view source_;
+    operator_mode operators_;
+    sstd::resource_vector<token> tokens_;
+    sstd::resource_vector<token> trivia_;
+    sstd::resource_vector<tokenizer_diagnostic> diagnostics_;
+    symbol_table symbols_{};
+    bool unterminated_ = false;
+
+    /// Last token or trivia, which is the one ending at the end of the stitched source.
+    [[nodiscard]] auto last_piece() -> token& {
+        if (trivia_.empty()) return tokens_.back();
+        if (tokens_.empty()) return trivia_.back();
+        return tokens_.back().offset > trivia_.back().offset ? tokens_.back() : trivia_.back();
+    }
+
+    [[nodiscard]] auto starts_line_comment(const token& t) const -> bool {
+        return t.type == token_type::comment and source_.substr(t.offset, 2) == u8"//";
+    }
+
+    /// Continues the last piece with the first piece of \p state, if tokenizer would have.
+    ///
+    /// Chunk ends with a newline, so its last piece is whitespace or a line comment,
+    /// because other pieces can not contain newline or would be unterminated.
+    void continue_last_piece(tokenize_state& state, const std::size_t chunk_begin) {
+        auto& last = last_piece();
+        // First piece of the chunk is either the first token or the first trivia.
+        auto& first_trivia = state.trivia;
+        if (not first_trivia.empty() and first_trivia.front().offset == 0) {
+            auto first = first_trivia.front();
+            first.offset += static_cast<std::uint32_t>(chunk_begin);
+
+            const auto whitespace_continues = last.type == token_type::whitespace
+                                              and first.type == token_type::whitespace;
+            const auto line_comment_continues =
+                starts_line_comment(last) and starts_line_comment(first);
+            if (whitespace_continues or line_comment_continues) {
+                last.length += first.length;
+                first_trivia.erase(first_trivia.begin());
+                return;
+            }
+        }
+
+        // Last piece is trivia, so the first piece of the chunk is preceded by whitespace.
+        if (not state.tokens.empty() and state.tokens.front().offset == 0)
+            state.tokens.front().preceded_by_whitespace = true;
+        if (not state.trivia.empty() and state.trivia.front().offset == 0)
+            state.trivia.front().preceded_by_whitespace = true;
+    }
+
+    /// Offset in \p text one past the end of \p open, which is a literal or a block comment
+    /// continuing to \p text, or nullopt if it continues past \p text.
+    ///
+    /// \p text begins after a newline, so no delimiter or escape continues into it.
+    [[nodiscard]] auto open_piece_end(const token& open, const std::u8string_view text) const
+        -> std::optional<std::size_t> {
+        if (open.type == token_type::comment) {
+            const auto delimiter = text.find(u8"*/");
+            if (delimiter == std::u8string_view::npos) return {};
+            return delimiter + 2;
+        }
+
+        const auto literal   = source_.substr(open.offset, open.length);
+        const auto delimiter = literal.front();
+        const auto is_raw =
+            literal.size() >= 3 and literal[1] == delimiter and literal[2] == delimiter;
+        if (is_raw) {
+            for (auto i = 0uz; i < text.size(); ++i) {
+                i += find_either(text.substr(i), delimiter, delimiter);
+                if (i + 3 > text.size()) break;
+                if (text[i + 1] == delimiter and text[i + 2] == delimiter) return i + 3;
+            }
+            return {};
+        }
+        for (auto i = 0uz; i < text.size();) {
+            i += find_either(text.substr(i), delimiter, u8'\\');
+            if (i == text.size()) break;
+            if (text[i] == delimiter) return i + 1;
+            // Escape next char after backslash if it exists.
+            i += 2;
+        }
+        return {};
+    }
+
+    /// Reports invalid UTF-8 in code units [\p begin, \p end) of \p literal,
+    /// unless it is already reported, as only the first one of a literal is.
+    void diagnose_literal_part(const token& literal,
+                               const std::size_t begin,
+                               const std::size_t end) {
+        const auto reported = not diagnostics_.empty()
+                              and diagnostics_.back().offset >= literal.offset
+                              and diagnostics_.back().kind
+                                      == diagnostic_kind::invalid_utf8_in_literal;
+        if (reported) return;
+
+        const auto part    = source_.substr(begin, end - begin);
+        const auto invalid = find_invalid_utf8(part);
+        if (invalid == part.size()) return;
+        diagnostics_.push_back({ .kind   = diagnostic_kind::invalid_utf8_in_literal,
+                                 .offset = static_cast<std::uint32_t>(begin + invalid),
+                                 .length = 1 });
+    }
+
+    void append(const tokenize_state& state, const std::size_t begin) {
+        // Interning the symbols of the chunk in order keeps ids in order of first occurrence.
+        auto chunk_symbols = std::vector<symbol_id>{};
+        chunk_symbols.reserve(state.symbols.size());
+        for (const auto i : std::views::iota(0uz, state.symbols.size())) {
+            const auto id = first_identifier_id + static_cast<symbol_id>(i);
+            chunk_symbols.push_back(symbols_.intern(state.symbols.name(id)));
+        }
+
+        auto shifted = [&](token t) {
+            t.offset += static_cast<std::uint32_t>(begin);
+            if (t.symbol != no_symbol and t.symbol >= first_identifier_id)
+                t.symbol = chunk_symbols[t.symbol - first_identifier_id];
+            return t;
+        };
+        std::ranges::copy(state.tokens | std::views::transform(shifted),
+                          std::back_inserter(tokens_));
+        std::ranges::copy(state.trivia | std::views::transform(shifted),
+                          std::back_inserter(trivia_));
+        for (auto d : state.diagnostics) {
+            d.offset += static_cast<std::uint32_t>(begin);
+            diagnostics_.push_back(d);
+        }
+        unterminated_ = state.unterminated;
+    }
+
+  public:
+    /// Chunks have been tokenized with \p operators.
+    ///
+    /// Stitched tokens are allocated from \p resource, or with std::allocator if it is nullptr.
+    [[nodiscard]] chunk_stitcher(const std::u8string_view source,
+                                 const operator_mode operators,
+                                 std::pmr::memory_resource* const resource)
+        : source_{ source },
+          operators_{ operators },
+          tokens_(resource),
+          trivia_(resource),
+          diagnostics_(resource) {}
+
+    /// Adds tokens of chunk [\p begin, \p end), which were tokenized as their own source.
+    ///
+    /// If the previous chunk ended inside a literal or a block comment,
+    /// only this chunk is scanned for its end and tokenized again after it.
+    void add(tokenize_state&& chunk, const std::size_t begin, const std::size_t end) {
+        if (tokens_.empty() and trivia_.empty()) {
+            append(chunk, begin);
+            return;
+        }
+
+        if (not unterminated_) {
+            continue_last_piece(chunk, begin);
+            append(chunk, begin);
+            return;
+        }
+
+        // Previous chunk ended inside a literal or a block comment,
+        // so tokens of this chunk are wrong and are replaced.
+        auto& last           = last_piece();
+        const auto text      = source_.substr(begin, end - begin);
+        const auto open_end  = open_piece_end(last, text);
+        const auto piece_end = begin + open_end.value_or(text.size());
+        if (last.type == token_type::literal) diagnose_literal_part(last, begin, piece_end);
+        last.length = static_cast<std::uint32_t>(piece_end - last.offset);
+        if (not open_end) return;
+
+        const auto after_comment = last.type == token_type::comment;
+        auto rest = run_tokenizer(source_.substr(piece_end, end - piece_end),
+                                  trivia_mode::side_table,
+                                  operators_);
+        // Comment is trivia, so the piece after it is preceded by whitespace.
+        if (not rest.tokens.empty() and rest.tokens.front().offset == 0)
+            rest.tokens.front().preceded_by_whitespace = after_comment;
+        if (not rest.trivia.empty() and rest.trivia.front().offset == 0)
+            rest.trivia.front().preceded_by_whitespace = after_comment;
+        append(rest, piece_end);
+    }
+
+    /// Stitched tokens with trivia handled as in \p mode.
+    [[nodiscard]] auto finish(source_ownership source, const trivia_mode mode)
+        -> token_buffer {
+        if (mode == trivia_mode::side_table) {
+            return { std::move(source),
+                     std::move(tokens_),
+                     std::move(trivia_),
+                     mode,
+                     std::move(symbols_),
+                     operators_,
+                     std::move(diagnostics_) };
+        }
+
+        // Whitespace is part of the tokens and comments are discarded.
+        auto tokens = sstd::resource_vector<token>(tokens_.get_allocator());
+        tokens.reserve(tokens_.size() + trivia_.size());
+        std::ranges::merge(tokens_,
+                           trivia_ | std::views::filter([](const token& t) {
+                               return t.type == token_type::whitespace;
+                           }),
+                           std::back_inserter(tokens),
+                           {},
+                           &token::offset,
+                           &token::offset);
+        return { std::move(source),
+                 std::move(tokens),
+                 {},
+                 mode,
+                 std::move(symbols_),
+                 operators_,
+                 std::move(diagnostics_) };
+    }
+};
+
+} // namespace detail
+
+/// Tokenizes \p source like tokenize, but splits it to chunks which are tokenized in parallel.
+///
+/// Chunks are split at newlines and tokenized speculatively as if each of them was a source
+/// of its own. When stitched together, the pieces continuing over chunk boundaries are joined.
+/// Chunk beginning inside a literal or a block comment is scanned for its end,
+/// and only the rest of that chunk is tokenized again, so every code unit is tokenized
+/// at most twice and the result is identical to tokenize.
+/// Chunks begin after a newline, so no operator continues over a chunk boundary
+/// and operators are tokenized as in \p operators.
+///
+/// Source is split to at most \p thread_count chunks, which are at least \p min_chunk_size long.
+///
+/// Tokens and trivia are allocated from \p resource, or with std::allocator if it is nullptr.
+/// The resource is used only on the calling thread, so it does not have to be thread safe.
+[[nodiscard]] inline auto
+    tokenize_parallel(source_code& source,
+                      const trivia_mode mode        = trivia_mode::in_stream,
+                      const operator_mode operators = operator_mode::single_character,
+                      const std::size_t thread_count =
+                          std::max(1u, std::thread::hardware_concurrency()),
+                      const std::size_t min_chunk_size          = 256uz * 1024uz,
+                      std::pmr::memory_resource* const resource = nullptr) -> token_buffer {
+    const auto sv = source.sv();
+    if (sv.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{ "Source code is too large to be tokenized!" };
+    }
+
+    const auto chunk_count = std::clamp(sv.size() / std::max(1uz, min_chunk_size),
+                                        1uz,
+                                        std::max(1uz, thread_count));
+    const auto boundaries  = detail::chunk_boundaries(sv, chunk_count);
+    const auto chunks      = boundaries.size() - 1;
+
+    auto states =
+        std::vector<tokenize_state>(chunks, tokenize_state{ {}, trivia_mode::side_table });
+    auto errors = std::vector<std::exception_ptr>(chunks);
+    {
+        auto workers = std::vector<std::jthread>{};
+        workers.reserve(chunks);
+        for (const auto i : std::views::iota(0uz, chunks)) {
+            workers.emplace_back([&, i] {
+                try {
+                    const auto chunk = sv.substr(boundaries[i], boundaries[i + 1] - boundaries[i]);
+                    states[i]        = run_tokenizer(chunk, trivia_mode::side_table, operators);
+                } catch (...) { errors[i] = std::current_exception(); }
+            });
+        }
+    }
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    auto stitcher = detail::chunk_stitcher{ sv, operators, resource };
+    for (const auto i : std::views::iota(0uz, chunks)) {
+        stitcher.add(std::move(states[i]), boundaries[i], boundaries[i + 1]);
+    }
+    return stitcher.finish(source.get_ownership_of_code(), mode);
+}
+
+} // namespace hycc
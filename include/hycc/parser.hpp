@@ -3,39 +3,79 @@
 /// @file Includes the implementation of the parser.
 
 #include <algorithm>
+#include <array>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <expected>
 #include <format>
+#include <iterator>
 #include <optional>
 #include <ranges>
 #include <span>
+#include <stdexcept>
 #include <string>
-#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "hycc/tokenizer.hpp"
 
 namespace hycc {
 
+/// Syntax error, which is formatted to a message only when the message is needed.
+struct syntax_diagnostic {
+    /// Unexpected token, or nullopt at the end of file.
+    std::optional<token> at;
+
+    [[nodiscard]] auto message(const token_buffer& buffer) const -> std::string {
+        if (not at) return "syntax error at end of file";
+
+        const auto sv       = buffer.sv(at.value());
+        const auto sv_str   = std::string{ sv.begin(), sv.end() };
+        const auto position = buffer.position(at.value());
+        return std::format("syntax error at [{}:{}]: {}", position.row, position.column, sv_str);
+    }
+    [[nodiscard]] friend constexpr bool operator==(const syntax_diagnostic&,
+                                                   const syntax_diagnostic&) = default;
+};
+
 class syntax_error : std::exception {
     std::string what_;
 
   public:
-    [[nodiscard]] syntax_error(const token& t) {
-        const auto sv_str = std::string{ t.sv_in_source.begin(), t.sv_in_source.end() };
-        what_             = std::format("syntax error at [{}:{}]: {}", t.row, t.column, sv_str);
-    }
+    [[nodiscard]] syntax_error(const token_buffer& buffer, const syntax_diagnostic& diagnostic)
+        : what_{ diagnostic.message(buffer) } {}
+    [[nodiscard]] syntax_error(const token_buffer& buffer, const token& t)
+        : syntax_error{ buffer, syntax_diagnostic{ t } } {}
     [[nodiscard]] syntax_error() : what_{ "syntax error at end of file" } {}
 
     const char* what() const noexcept { return what_.c_str(); }
 };
 
+/// How parser_t reports syntax errors.
+enum class error_mode : std::uint8_t {
+    /// Throw syntax_error at the first syntax error.
+    throw_exception,
+    /// Store a syntax_diagnostic of each syntax error and return it as parse_result,
+    /// so that scopes can continue parsing after the error.
+    recover
+};
+
+/// Result of pushing a node, which is the syntax error if the node could not be parsed.
+using parse_result = std::expected<void, syntax_diagnostic>;
+
 struct token_pattern {
     token_type type;
     std::u8string_view sv;
+    /// Keywords and single characters are matched by comparing symbols instead of text.
+    symbol_id symbol = fixed_symbol_id(sv);
 
-    [[nodiscard]] constexpr auto match(const token& t) const {
-        return type == t.type and sv == t.sv_in_source;
+    [[nodiscard]] constexpr auto match(const token_buffer& buffer, const token& t) const {
+        if (type != t.type) return false;
+        if (symbol != no_symbol and t.symbol != no_symbol) return symbol == t.symbol;
+        return sv == buffer.sv(t);
     }
     [[nodiscard]] friend constexpr bool operator==(const token_pattern&,
                                                    const token_pattern&) = default;
@@ -44,35 +84,249 @@ struct token_pattern {
 template<typename T>
 concept token_matchable = std::same_as<T, token_pattern> or std::same_as<T, token_type>;
 
+namespace detail {
+
+/// Smallest unsigned integer with a bit for each of \p N alternatives.
+template<std::size_t N>
+using alternative_mask = std::conditional_t<
+    N <= 8,
+    std::uint8_t,
+    std::conditional_t<N <= 16,
+                       std::uint16_t,
+                       std::conditional_t<N <= 32, std::uint32_t, std::uint64_t>>>;
+
+inline constexpr auto token_type_count = static_cast<std::size_t>(token_type::error) + 1;
+
+/// Fixed symbols are keys of their own, and interned identifiers and no_symbol have one key each.
+inline constexpr auto symbol_key_count = std::size_t{ first_identifier_id } + 2;
+
+[[nodiscard]] constexpr auto symbol_key(const symbol_id symbol) noexcept -> std::size_t {
+    if (symbol == no_symbol) return first_identifier_id + 1;
+    return std::min(symbol, first_identifier_id);
+}
+
+} // namespace detail
+
+/// Alternative patterns, which are tried in the given order.
+///
+/// Alternatives are non-empty arrays of token_pattern or token_type.
+/// Type and symbol of the first token are used to look up the alternatives,
+/// which may match it, from a table computed at compile time,
+/// so choosing among the alternatives does not try to match each of them.
+template<const auto&... Alternatives>
+class pattern_set {
+  public:
+    static constexpr auto size = sizeof...(Alternatives);
+    static_assert(size > 0 and size <= 64, "pattern_set supports from 1 to 64 alternatives!");
+    static_assert(((std::size(Alternatives) > 0) and ...), "Alternatives can not be empty!");
+
+    /// Bit i is set for the alternative i.
+    using mask = detail::alternative_mask<size>;
+
+  private:
+    /// Can \p p match a token of type \p type with symbol, whose key is \p key.
+    [[nodiscard]] static constexpr bool
+        may_match(const token_matchable auto p, const token_type type, const std::size_t key) {
+        if constexpr (std::same_as<std::remove_cvref_t<decltype(p)>, token_type>) {
+            return p == type;
+        } else {
+            if (p.type != type) return false;
+            // Text is compared, if either the pattern or the token has no symbol.
+            if (p.symbol == no_symbol or key == detail::symbol_key(no_symbol)) return true;
+            return detail::symbol_key(p.symbol) == key;
+        }
+    }
+
+    static constexpr auto candidate_table = [] {
+        auto table = std::array<std::array<mask, detail::symbol_key_count>,
+                                detail::token_type_count>{};
+        auto bit   = mask{ 1 };
+        const auto add_alternative = [&](const auto& alternative) {
+            for (auto type = 0uz; type < table.size(); ++type) {
+                for (auto key = 0uz; key < table[type].size(); ++key) {
+                    if (not may_match(alternative.front(), static_cast<token_type>(type), key)) {
+                        continue;
+                    }
+                    table[type][key] = static_cast<mask>(table[type][key] | bit);
+                }
+            }
+            bit = static_cast<mask>(bit << 1);
+        };
+        (add_alternative(Alternatives), ...);
+        return table;
+    }();
+
+  public:
+    /// Alternatives, whose first pattern may match \p t.
+    [[nodiscard]] static constexpr auto candidates(const token& t) noexcept -> mask {
+        return candidate_table[static_cast<std::size_t>(t.type)][detail::symbol_key(t.symbol)];
+    }
+};
+
+/// Tokens matched by parser_t, which are a subspan of the tokens of its token_buffer.
+///
+/// Span covers the matched tokens from the first to the last one,
+/// so in trivia_mode::in_stream it includes whitespace skipped between them.
+/// In trivia_mode::side_table whitespace is not stored with the tokens,
+/// so the span has only the matched tokens, which are not whitespace.
+///
+/// Valid as long as the token_buffer is alive.
+using matched_tokens = std::span<token const>;
+
+/// Position of parser_t, which can be restored to backtrack.
+struct parser_checkpoint {
+    /// Index of the next unparsed token in the tokens of the buffer.
+    std::size_t next_unparsed;
+    /// In trivia_mode::side_table, is the whitespace before the next unparsed token parsed.
+    bool whitespace_parsed;
+    std::size_t next_significant;
+    /// Diagnostics reported after the checkpoint are removed when it is restored.
+    std::size_t diagnostic_count;
+
+    [[nodiscard]] friend constexpr bool operator==(const parser_checkpoint&,
+                                                   const parser_checkpoint&) = default;
+};
+
 class parser_t {
-    std::span<token const> tokens_;
-    std::size_t next_unparsed_index_{ 0 };
+    const token_buffer* buffer_;
+    error_mode error_mode_;
+    std::vector<syntax_diagnostic> diagnostics_{};
+    /// Index of each significant token in the tokens of the buffer in trivia_mode::in_stream.
+    ///
+    /// In trivia_mode::side_table every token is significant, so this is left empty.
+    std::vector<std::size_t> significant_indices_{};
+    /// Index of the next unparsed token in the tokens of the buffer.
+    std::size_t next_unparsed_{ 0 };
+    /// In trivia_mode::side_table trivia before a token is parsed as one whitespace token,
+    /// when whitespace is not skipped.
+    bool whitespace_parsed_{ false };
+    /// Index of the first significant token at or after next unparsed.
+    std::size_t next_significant_{ 0 };
+
+    /// Position in the tokens including whitespace.
+    struct cursor {
+        std::size_t next_unparsed;
+        bool whitespace_parsed;
+    };
+
+    [[nodiscard]] constexpr auto significant_count() const noexcept -> std::size_t {
+        if (buffer_->mode() == trivia_mode::side_table) return buffer_->size();
+        return significant_indices_.size();
+    }
+
+    /// Index of the significant token \p n in the tokens of the buffer.
+    [[nodiscard]] constexpr auto significant_index(const std::size_t n) const noexcept
+        -> std::size_t {
+        if (buffer_->mode() == trivia_mode::side_table) return n;
+        return significant_indices_[n];
+    }
+
+    [[nodiscard]] constexpr auto significant_token(const std::size_t n) const noexcept
+        -> const token& {
+        return (*buffer_)[significant_index(n)];
+    }
+
+    /// Tokens of the buffer from the significant token \p first to the last of \p count of them.
+    [[nodiscard]] constexpr auto significant_span(const std::size_t first,
+                                                  const std::size_t count) const noexcept
+        -> matched_tokens {
+        const auto tokens = buffer_->tokens();
+        if (count == 0) return tokens.subspan(next_unparsed_, 0);
+        const auto begin = significant_index(first);
+        return tokens.subspan(begin, significant_index(first + count - 1) + 1 - begin);
+    }
 
-    [[nodiscard]] constexpr auto tokens_left() { return tokens_.size() - next_unparsed_index_; }
-    [[nodiscard]] constexpr decltype(auto) get_unparsed_tokens() {
-        return tokens_.subspan(next_unparsed_index_);
+    /// Consumes \p n unparsed significant tokens and the whitespace between them.
+    constexpr void consume_significant(const std::size_t n) noexcept {
+        if (n == 0) return;
+        next_significant_ += n;
+        next_unparsed_     = significant_index(next_significant_ - 1) + 1;
+        whitespace_parsed_ = false;
     }
 
-    [[nodiscard]] static constexpr bool match_pattern(const token_matchable auto p,
-                                                      const token& t) {
+    /// Next token at \p c including whitespace, which \p c is advanced past,
+    /// or nullopt at the end of the tokens.
+    ///
+    /// In trivia_mode::side_table whitespace token is made from the trivia before the token.
+    [[nodiscard]] constexpr auto next_with_whitespace(cursor& c) const -> std::optional<token> {
+        if (buffer_->mode() == trivia_mode::side_table and not c.whitespace_parsed) {
+            c.whitespace_parsed = true;
+            if (const auto whitespace = buffer_->whitespace_before(c.next_unparsed)) {
+                return whitespace;
+            }
+        }
+        if (c.next_unparsed == buffer_->size()) return {};
+        c.whitespace_parsed = false;
+        return (*buffer_)[c.next_unparsed++];
+    }
+
+    /// Tokens of the buffer from the next unparsed token to \p c.
+    [[nodiscard]] constexpr auto span_to(const cursor c) const noexcept -> matched_tokens {
+        return buffer_->tokens().subspan(next_unparsed_, c.next_unparsed - next_unparsed_);
+    }
+
+    /// Consumes unparsed tokens including whitespace until \p c.
+    constexpr void consume_to(const cursor c) noexcept {
+        next_unparsed_     = c.next_unparsed;
+        whitespace_parsed_ = c.whitespace_parsed;
+        if (buffer_->mode() == trivia_mode::side_table) {
+            next_significant_ = next_unparsed_;
+            return;
+        }
+        while (next_significant_ < significant_indices_.size()
+               and significant_indices_[next_significant_] < next_unparsed_) {
+            ++next_significant_;
+        }
+    }
+
+    /// Next unparsed token, which is not whitespace if \p skip_whitespace.
+    [[nodiscard]] constexpr auto next_token(const bool skip_whitespace) const
+        -> std::optional<token> {
+        if (not skip_whitespace) {
+            auto c = cursor{ next_unparsed_, whitespace_parsed_ };
+            return next_with_whitespace(c);
+        }
+        if (next_significant_ == significant_count()) return {};
+        return significant_token(next_significant_);
+    }
+
+    /// Moves to the position of \p c.
+    constexpr void move_to(const parser_checkpoint& c) noexcept {
+        next_unparsed_     = c.next_unparsed;
+        whitespace_parsed_ = c.whitespace_parsed;
+        next_significant_  = c.next_significant;
+    }
+
+    [[nodiscard]] constexpr bool match_pattern(const token_matchable auto p, const token& t) const {
         if constexpr (std::same_as<std::remove_cvref_t<decltype(p)>, token_type>) {
             return p == t.type;
         } else {
-            return p.match(t);
+            return p.match(*buffer_, t);
         }
 
         static_assert(true, "This should not happen, due to token_matchable constraint :)");
     }
 
   public:
-    [[nodiscard]] parser_t(const std::span<token const> tokens) : tokens_{ tokens } {}
+    [[nodiscard]] constexpr parser_t(const token_buffer& buffer,
+                                     const error_mode mode = error_mode::throw_exception)
+        : buffer_{ &buffer },
+          error_mode_{ mode } {
+        if (buffer.mode() == trivia_mode::side_table) return;
+
+        const auto tokens = buffer.tokens();
+        significant_indices_.reserve(tokens.size());
+        for (auto i = 0uz; i < tokens.size(); ++i) {
+            if (tokens[i].type != token_type::whitespace) significant_indices_.push_back(i);
+        }
+    }
 
-    /// Ignores whitespace.
-    [[nodiscard]] constexpr bool all_parsed() noexcept {
-        namespace rv = std::ranges::views;
-        return std::ranges::empty(get_unparsed_tokens() | rv::filter([](const token& t) {
-                                      return not(t.type == token_type::whitespace);
-                                  }));
+    /// Buffer of the parsed tokens, which can be used to resolve text of the tokens.
+    [[nodiscard]] constexpr auto buffer() const noexcept -> const token_buffer& { return *buffer_; }
+
+    /// Ignores whitespace. Constant time.
+    [[nodiscard]] constexpr bool all_parsed() const noexcept {
+        return next_significant_ == significant_count();
     }
 
     /// Helper function to deduce the template argument for the span version.
@@ -87,115 +341,167 @@ class parser_t {
             skip_whitespace);
     }
 
+    /// Matched tokens are a subspan of the tokens of the buffer, so matching does not allocate.
     template<token_matchable T>
     [[nodiscard]] constexpr auto match_and_consume(const std::span<T const> pattern,
                                                    const bool skip_whitespace = true)
-        -> std::optional<std::vector<token>> {
-        if (pattern.empty()) return std::vector<token>{};
-
-        auto skip = [&](const token& t) {
-            return skip_whitespace and t.type == token_type::whitespace;
-        };
-
-        namespace rv = std::ranges::views;
-        auto potential_matches_with_indecies =
-            get_unparsed_tokens() | rv::enumerate | rv::filter([&](const auto& x) {
-                const auto& [_, t] = x;
-                if (skip(t)) return false;
-                return true;
-            });
-
-        auto matched_tokens_with_indecies = rv::zip(pattern, potential_matches_with_indecies)
-                                            | rv::filter([](const auto& x) {
-                                                  const auto& [p, i_t] = x;
-                                                  const auto& [_, t]   = i_t;
-                                                  return match_pattern(p, t);
-                                              })
-                                            | rv::transform([](const auto& x) {
-                                                  const auto& [_, i_t] = x;
-                                                  return i_t;
-                                              });
-
-        using fold_t = std::tuple<std::vector<token>,
-                                  std::ranges::range_difference_t<decltype(get_unparsed_tokens())>>;
-        // Appends matched tokens together and take index of x unconditionally,
-        // so afther the fold it will contain the last matched index.
-        auto fold_f = [](fold_t lhs, const auto& x) {
-            const auto& [i, t] = x;
-            std::get<0>(lhs).push_back(t);
-            std::get<1>(lhs) = i;
-            return lhs;
-        };
-        auto [matched_tokens, last_index] =
-            std::ranges::fold_left(matched_tokens_with_indecies, fold_t{}, fold_f);
+        -> std::optional<matched_tokens> {
+        if (skip_whitespace) {
+            if (significant_count() - next_significant_ < pattern.size()) return {};
+            for (auto n = 0uz; n < pattern.size(); ++n) {
+                if (not match_pattern(pattern[n], significant_token(next_significant_ + n))) {
+                    return {};
+                }
+            }
 
-        if (matched_tokens.size() == pattern.size()) {
             // All matched, so they can be consumed!
-            next_unparsed_index_ += static_cast<std::size_t>(last_index) + 1;
-            return matched_tokens;
+            const auto matched = significant_span(next_significant_, pattern.size());
+            consume_significant(pattern.size());
+            return matched;
         }
-        return {};
+
+        auto c = cursor{ next_unparsed_, whitespace_parsed_ };
+        for (const auto& p : pattern) {
+            const auto t = next_with_whitespace(c);
+            if (not t or not match_pattern(p, t.value())) return {};
+        }
+        const auto matched = span_to(c);
+        consume_to(c);
+        return matched;
     }
 
-    using matched_type =
-        decltype(std::declval<parser_t>().match_and_consume(std::span<token_type const>{}, false));
+    using matched_type = std::optional<matched_tokens>;
+
+    /// Alternative of pattern_set which was matched.
+    struct matched_alternative {
+        /// Index of the alternative in the pattern_set.
+        std::size_t index;
+        matched_tokens tokens;
+    };
+
+    /// Matches the first alternative of \p set, which matches the unparsed tokens.
+    ///
+    /// Only the alternatives, which may match the next token, are tried.
+    template<const auto&... Alternatives>
+    [[nodiscard]] constexpr auto match_and_consume(const pattern_set<Alternatives...> set,
+                                                   const bool skip_whitespace = true)
+        -> std::optional<matched_alternative> {
+        const auto next = next_token(skip_whitespace);
+        if (not next) return {};
+
+        const auto candidates = set.candidates(next.value());
+        auto matched          = std::optional<matched_alternative>{};
+        auto index            = 0uz;
+        const auto try_alternative = [&](const auto& alternative) {
+            const auto i = index++;
+            if (((candidates >> i) & 1u) == 0u) return false;
+            if (const auto tokens = match_and_consume(alternative, skip_whitespace)) {
+                matched = matched_alternative{ i, tokens.value() };
+            }
+            return matched.has_value();
+        };
+        // Short circuits at the first alternative which matches.
+        [[maybe_unused]] const auto _ = (try_alternative(Alternatives) or ...);
+        return matched;
+    }
 
     /// Consumes until pattern is matched. Matched token is not included in return value but is parsed.
     [[nodiscard]] constexpr auto consume_until(const token_matchable auto pattern,
                                                const bool skip_whitespace = true) -> matched_type {
-        auto skip = [&](const token& t) {
-            return skip_whitespace and t.type == token_type::whitespace;
-        };
-
-        namespace rv                      = std::ranges::views;
-        auto matched_tokens_with_indecies = get_unparsed_tokens() | rv::enumerate
-                                            | rv::filter([&](const auto& x) {
-                                                  const auto& [_, t] = x;
-                                                  if (skip(t)) return false;
-                                                  return true;
-                                              })
-                                            | rv::take_while([&](const auto& x) {
-                                                  return not match_pattern(pattern, std::get<1>(x));
-                                              });
-
-        if (matched_tokens_with_indecies.empty()) {
-            // Nothing matched
-            if (match_and_consume(std::vector{ pattern }, skip_whitespace)) {
-                // Because pattern was first that matched.
-                return matched_type::value_type{};
+        if (skip_whitespace) {
+            for (auto n = next_significant_; n < significant_count(); ++n) {
+                if (match_pattern(pattern, significant_token(n))) {
+                    const auto skipped = significant_span(next_significant_, n - next_significant_);
+                    consume_significant(n - next_significant_ + 1);
+                    return skipped;
+                }
             }
-
+            // Pattern was not present.
             return {};
         }
-        using fold_t = std::tuple<std::vector<token>,
-                                  std::ranges::range_difference_t<decltype(get_unparsed_tokens())>>;
-        // Appends matched tokens together and take index of x unconditionally,
-        // so afther the fold it will contain the last matched index.
-        auto fold_f = [](fold_t lhs, const auto& x) {
-            const auto& [i, t] = x;
-            std::get<0>(lhs).push_back(t);
-            std::get<1>(lhs) = i;
-            return lhs;
-        };
-        auto [matched_tokens, last_index] =
-            std::ranges::fold_left(matched_tokens_with_indecies, fold_t{}, fold_f);
 
-        if (last_index + 1 == std::ranges::ssize(tokens_)) {
-            // Everything was matched, i.e. pattern was not present.
-            return {};
+        auto c = cursor{ next_unparsed_, whitespace_parsed_ };
+        for (auto before = c; const auto t = next_with_whitespace(c); before = c) {
+            if (match_pattern(pattern, t.value())) {
+                const auto skipped = span_to(before);
+                consume_to(c);
+                return skipped;
+            }
         }
+        // Pattern was not present.
+        return {};
+    }
+
+    /// Skips unparsed tokens until after semantic scope operator ; or before },
+    /// which are not inside {} skipped on the way, so that parsing can continue after an error.
+    constexpr auto synchronize() -> matched_tokens {
+        constexpr auto open  = token_pattern{ token_type::semantic_scope_operator, u8"{" };
+        constexpr auto close = token_pattern{ token_type::semantic_scope_operator, u8"}" };
+        constexpr auto end   = token_pattern{ token_type::semantic_scope_operator, u8";" };
+
+        const auto first = next_significant_;
+        auto depth       = 0uz;
+        auto n           = first;
+        for (; n < significant_count(); ++n) {
+            const auto& t = significant_token(n);
+            if (match_pattern(open, t)) {
+                ++depth;
+            } else if (match_pattern(close, t)) {
+                if (depth == 0) break;
+                --depth;
+            } else if (depth == 0 and match_pattern(end, t)) {
+                ++n;
+                break;
+            }
+        }
+        const auto skipped = significant_span(first, n - first);
+        consume_significant(n - first);
+        return skipped;
+    }
 
-        // + 1 from indexing starting at 0.
-        // + 1 from consuming the matched pattern.
-        next_unparsed_index_ += static_cast<std::size_t>(last_index) + 1 + 1;
+    [[nodiscard]] constexpr auto mode() const noexcept -> error_mode { return error_mode_; }
 
-        return matched_tokens;
+    [[nodiscard]] constexpr auto checkpoint() const noexcept -> parser_checkpoint {
+        return { next_unparsed_, whitespace_parsed_, next_significant_, diagnostics_.size() };
     }
 
+    /// Backtracks to \p c, which has to be a checkpoint taken earlier from this parser.
+    constexpr void restore(const parser_checkpoint& c) noexcept {
+        move_to(c);
+        diagnostics_.erase(diagnostics_.begin() + static_cast<std::ptrdiff_t>(c.diagnostic_count),
+                           diagnostics_.end());
+    }
+
+    /// Syntax errors reported in error_mode::recover.
+    [[nodiscard]] constexpr auto diagnostics() const noexcept
+        -> std::span<syntax_diagnostic const> {
+        return diagnostics_;
+    }
+
+    /// Reports syntax error at \p diagnostic.
+    ///
+    /// Throws syntax_error in error_mode::throw_exception,
+    /// otherwise stores the diagnostic and returns it as the error of parse_result.
+    [[nodiscard]] constexpr auto report_syntax_error(const syntax_diagnostic& diagnostic)
+        -> std::unexpected<syntax_diagnostic> {
+        if (error_mode_ == error_mode::throw_exception) throw syntax_error{ *buffer_, diagnostic };
+        diagnostics_.push_back(diagnostic);
+        return std::unexpected{ diagnostic };
+    }
+
+    /// Reports syntax error at the next unparsed token which is not whitespace.
+    [[nodiscard]] constexpr auto report_syntax_error() -> std::unexpected<syntax_diagnostic> {
+        return report_syntax_error(next_token_diagnostic());
+    }
+
+    /// Throws syntax_error at the next unparsed token which is not whitespace.
     constexpr void throw_syntax_error(this auto&& self) {
-        if (self.tokens_left()) throw syntax_error{ self.get_unparsed_tokens().front() };
-        else
-            throw syntax_error{};
+        throw syntax_error{ *self.buffer_, self.next_token_diagnostic() };
+    }
+
+  private:
+    [[nodiscard]] constexpr auto next_token_diagnostic() const -> syntax_diagnostic {
+        return { next_token(true) };
     }
 };
 
@@ -0,0 +1,158 @@
+#pragma once
+
+/// @file Intrinsic prelude, which is tokenized at compile time.
+///
+/// Every compilation begins by adding the intrinsics to the global scope,
+/// see docs/sphinx/parser.rst. Tokens of the declarations of the intrinsics are computed
+/// at compile time to static tables, so that a compilation does not tokenize them again.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "hycc/symbol_table.hpp"
+#include "hycc/tokenizer.hpp"
+
+namespace hycc {
+
+/// Declarations of the intrinsics.
+inline constexpr auto prelude_source = std::u8string_view{
+    u8"// Intrinsics, which are in the global scope of every compilation.\n"
+    u8"\n"
+    u8"void: type;\n"
+    u8"bool: type;\n"
+    u8"char: type;\n"
+    u8"uchar: type;\n"
+    u8"short: type;\n"
+    u8"ushort: type;\n"
+    u8"int: type;\n"
+    u8"uint: type;\n"
+    u8"long: type;\n"
+    u8"ulong: type;\n"
+    u8"longlong: type;\n"
+    u8"ulonglong: type;\n"
+    u8"f32: type;\n"
+    u8"f64: type;\n"
+    u8"size_t: type;\n"
+    u8"\n"
+    u8"sizeof: (in t: type) -> size_t;\n"
+};
+
+namespace detail {
+
+/// Tokens, trivia and identifiers of the prelude in tables of the size of the source,
+/// which bounds the counts of them, so that the exact sized tables below
+/// are built from a single tokenization of the prelude.
+struct tokenized_prelude {
+    std::array<token, prelude_source.size()> tokens{};
+    std::size_t token_count = 0;
+    std::array<token, prelude_source.size()> trivia{};
+    std::size_t trivia_count = 0;
+    /// Text of the identifiers in the order of their symbol ids.
+    std::array<std::u8string_view, prelude_source.size()> identifiers{};
+    std::size_t identifier_count = 0;
+    bool unterminated            = false;
+    bool has_error_tokens        = false;
+};
+
+[[nodiscard]] consteval auto tokenize_prelude() -> tokenized_prelude {
+    const auto state = run_tokenizer(prelude_source, trivia_mode::side_table);
+
+    auto prelude         = tokenized_prelude{};
+    prelude.token_count  = state.tokens.size();
+    prelude.trivia_count = state.trivia.size();
+    std::ranges::copy(state.tokens, prelude.tokens.begin());
+    std::ranges::copy(state.trivia, prelude.trivia.begin());
+
+    prelude.identifier_count = state.symbols.size();
+    for (const auto& t : state.tokens) {
+        if (t.type != token_type::identifier or t.symbol < first_identifier_id) continue;
+        prelude.identifiers[t.symbol - first_identifier_id] =
+            prelude_source.substr(t.offset, t.length);
+    }
+
+    prelude.unterminated     = state.unterminated;
+    prelude.has_error_tokens = std::ranges::any_of(state.tokens, [](const token& t) {
+        return t.type == token_type::error;
+    });
+    return prelude;
+}
+
+inline constexpr auto prelude_tokenized = tokenize_prelude();
+
+inline constexpr auto prelude_token_count      = prelude_tokenized.token_count;
+inline constexpr auto prelude_trivia_count     = prelude_tokenized.trivia_count;
+inline constexpr auto prelude_identifier_count = prelude_tokenized.identifier_count;
+
+static_assert(not prelude_tokenized.unterminated, "Prelude ends inside a literal!");
+static_assert(not prelude_tokenized.has_error_tokens, "Prelude contains error tokens!");
+
+inline constexpr auto prelude_token_table = [] {
+    auto tokens = std::array<token, prelude_token_count>{};
+    std::ranges::copy_n(prelude_tokenized.tokens.begin(), prelude_token_count, tokens.begin());
+    return tokens;
+}();
+
+inline constexpr auto prelude_trivia_table = [] {
+    auto trivia = std::array<token, prelude_trivia_count>{};
+    std::ranges::copy_n(prelude_tokenized.trivia.begin(), prelude_trivia_count, trivia.begin());
+    return trivia;
+}();
+
+/// Text of the identifiers of the prelude in the order of their symbol ids,
+/// referring to prelude_source, so they can be stored in a constexpr table.
+inline constexpr auto prelude_identifiers = [] {
+    auto identifiers = std::array<std::u8string_view, prelude_identifier_count>{};
+    std::ranges::copy_n(prelude_tokenized.identifiers.begin(),
+                        prelude_identifier_count,
+                        identifiers.begin());
+    return identifiers;
+}();
+
+/// Source code and symbols of the prelude, which are shared by every prelude_tokens.
+struct prelude_data {
+    source_ownership source;
+    symbol_table symbols;
+
+    /// Data of the prelude, which is built on the first call.
+    [[nodiscard]] static auto get() -> const prelude_data& {
+        static const auto data = [] {
+            // Interning in the order of the ids gives the identifiers the same ids as tokenize.
+            auto symbols = symbol_table{};
+            for (const auto name : prelude_identifiers) {
+                [[maybe_unused]] const auto _ = symbols.intern_identifier(name, hash_symbol(name));
+            }
+            auto source = source_code{ std::u8string{ prelude_source } };
+            return prelude_data{ source.get_ownership_of_code(), std::move(symbols) };
+        }();
+        return data;
+    }
+};
+
+} // namespace detail
+
+/// Tokens of prelude_source with trivia in a side table.
+///
+/// Gives the same tokens as tokenize(prelude_source, trivia_mode::side_table),
+/// but only copies them from the tables computed at compile time.
+/// Source code is shared by all calls and symbols are copied from a table built once.
+/// Tokens and trivia are allocated from \p resource, or with std::allocator if it is nullptr.
+[[nodiscard]] inline auto prelude_tokens(std::pmr::memory_resource* const resource = nullptr)
+    -> token_buffer {
+    const auto& prelude = detail::prelude_data::get();
+    return { prelude.source,
+             sstd::resource_vector<token>(detail::prelude_token_table.begin(),
+                                          detail::prelude_token_table.end(),
+                                          resource),
+             sstd::resource_vector<token>(detail::prelude_trivia_table.begin(),
+                                          detail::prelude_trivia_table.end(),
+                                          resource),
+             trivia_mode::side_table,
+             symbol_table{ prelude.symbols } };
+}
+
+} // namespace hycc
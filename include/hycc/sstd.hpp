@@ -1,31 +1,68 @@
 #pragma once
 
+#include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <memory_resource>
 #include <optional>
 #include <stdexcept>
 #include <tuple>
 #include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 
 /// @file supplement std (std)
 
 namespace hycc {
 namespace sstd {
 
-template<typename>
+/// How ownership keeps track of the owners of its object.
+enum class ownership_policy {
+    /// Plain reference count, so ownerships of the same object can not be used on many threads.
+    single_threaded,
+    /// Atomic reference count, so ownerships of the same object can be copied and destroyed
+    /// on many threads. Plain count is used in constant evaluation.
+    atomic,
+    /// Does not own the object, which has to outlive the ownership.
+    borrowed
+};
+
+template<typename T, ownership_policy = ownership_policy::single_threaded>
 class ownership;
 
-template<typename T>
+template<typename T, ownership_policy Policy = ownership_policy::single_threaded>
 class control_block {
-    std::size_t count_;
+    alignas(std::atomic_ref<std::size_t>::required_alignment) std::size_t count_;
     T shared_;
 
-    friend ownership<T>;
+    friend ownership<T, Policy>;
+
+    constexpr void acquire() noexcept {
+        if constexpr (Policy == ownership_policy::atomic) {
+            if !consteval {
+                std::atomic_ref{ count_ }.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        ++count_;
+    }
+
+    /// Returns true if the last owner was released.
+    [[nodiscard]] constexpr bool release() noexcept {
+        if constexpr (Policy == ownership_policy::atomic) {
+            if !consteval {
+                return std::atomic_ref{ count_ }.fetch_sub(1, std::memory_order_acq_rel) == 1;
+            }
+        }
+        return --count_ == 0;
+    }
 
   public:
+    static_assert(Policy != ownership_policy::borrowed, "Borrowed ownership has no control block!");
+
     [[nodiscard]] constexpr control_block(T&& args)
         : count_{ 0 },
           shared_{ std::forward<T>(args) } {}
@@ -36,50 +73,135 @@ class control_block {
     constexpr control_block operator=(control_block&&)      = delete;
     constexpr ~control_block()                              = default;
 
-    [[nodiscard]] constexpr auto get_ownership() -> ownership<T> {
-        ++count_;
+    [[nodiscard]] constexpr auto get_ownership() -> ownership<T, Policy> {
+        acquire();
         return { this };
     }
 
     [[nodiscard]] constexpr const auto& value(this auto&& me) { return me.shared_; }
 };
 
-/// Makes not not thread safe constexpr shared_ptr clone.
-template<typename T, typename... Args>
-constexpr auto make_shared_object(Args&&... args) -> ownership<T> {
-    return (new control_block<T>{ T{ std::forward<Args>(args)... } })->get_ownership();
+/// Makes constexpr shared_ptr clone, which is thread safe only with \p Policy atomic.
+template<typename T,
+         ownership_policy Policy = ownership_policy::single_threaded,
+         typename... Args>
+constexpr auto make_shared_object(Args&&... args) -> ownership<T, Policy> {
+    return (new control_block<T, Policy>{ T{ std::forward<Args>(args)... } })->get_ownership();
 }
 
 /// Reference counted (using control_block) ownership of stack allocation of object
-template<typename T>
+template<typename T, ownership_policy Policy>
 class ownership {
-    friend class control_block<T>;
+    friend class control_block<T, Policy>;
 
-    mutable control_block<T>* block_;
-    constexpr ownership(control_block<T>* const block) : block_{ block } {}
+    control_block<T, Policy>* block_;
+    constexpr ownership(control_block<T, Policy>* const block) : block_{ block } {}
 
   public:
     constexpr ownership() = delete;
-    constexpr ownership(const ownership& that) { *this = that.block_->get_ownership(); }
+    constexpr ownership(const ownership& that) : block_{ that.block_ } {
+        if (block_ != nullptr) block_->acquire();
+    }
     constexpr ownership& operator=(const ownership& that) {
-        return *this = that.block_->get_ownership();
+        // Copy first, so that self assignment does not release the object.
+        auto copy = that;
+        std::swap(block_, copy.block_);
+        return *this;
     }
-    constexpr ownership(ownership&& that) : block_{ that.block_ } { that.block_ = nullptr; };
-    constexpr ownership& operator=(ownership&& that) {
-        block_      = that.block_;
-        that.block_ = nullptr;
+    constexpr ownership(ownership&& that) noexcept
+        : block_{ std::exchange(that.block_, nullptr) } {}
+    constexpr ownership& operator=(ownership&& that) noexcept {
+        // Previously owned object is released by the destructor of moved.
+        auto moved = std::move(that);
+        std::swap(block_, moved.block_);
         return *this;
-    };
+    }
 
     constexpr ~ownership() {
         if (block_ == nullptr) return;
         // If no other ownership exits, clean up.
-        if (--(block_->count_) == 0) delete block_;
+        if (block_->release()) delete block_;
     }
 
     [[nodiscard]] constexpr const auto& value(this auto&& me) { return me.block_->value(); }
+
+    /// Non-owning view of the object, which can not outlive this ownership.
+    [[nodiscard]] constexpr auto borrow() const -> ownership<T, ownership_policy::borrowed> {
+        return ownership<T, ownership_policy::borrowed>{ value() };
+    }
+};
+
+/// Non-owning view of an object, which has to outlive it.
+template<typename T>
+class ownership<T, ownership_policy::borrowed> {
+    const T* object_;
+
+  public:
+    [[nodiscard]] constexpr explicit ownership(const T& object) : object_{ &object } {}
+
+    [[nodiscard]] constexpr const auto& value(this auto&& me) { return *me.object_; }
+};
+
+/// Allocator using std::pmr::memory_resource, which can also be used in constant evaluation.
+///
+/// Without a resource, and always in constant evaluation, memory is allocated with
+/// std::allocator. Like std::pmr::polymorphic_allocator, it is not propagated by containers.
+template<typename T>
+class resource_allocator {
+    std::pmr::memory_resource* resource_ = nullptr;
+
+  public:
+    using value_type = T;
+
+    [[nodiscard]] constexpr resource_allocator() noexcept = default;
+    [[nodiscard]] constexpr resource_allocator(std::pmr::memory_resource* const resource) noexcept
+        : resource_{ resource } {}
+    template<typename U>
+    [[nodiscard]] constexpr resource_allocator(const resource_allocator<U>& that) noexcept
+        : resource_{ that.resource() } {}
+
+    [[nodiscard]] constexpr auto allocate(const std::size_t n) -> T* {
+        if consteval {
+            return std::allocator<T>{}.allocate(n);
+        } else {
+            if (resource_ == nullptr) return std::allocator<T>{}.allocate(n);
+            return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+        }
+    }
+
+    constexpr void deallocate(T* const p, const std::size_t n) {
+        if consteval {
+            std::allocator<T>{}.deallocate(p, n);
+        } else {
+            if (resource_ == nullptr) return std::allocator<T>{}.deallocate(p, n);
+            resource_->deallocate(p, n * sizeof(T), alignof(T));
+        }
+    }
+
+    /// Copies of containers use std::allocator, as with std::pmr::polymorphic_allocator.
+    [[nodiscard]] constexpr auto select_on_container_copy_construction() const
+        -> resource_allocator {
+        return {};
+    }
+
+    /// Resource which memory is allocated from, or nullptr for std::allocator.
+    [[nodiscard]] constexpr auto resource() const noexcept -> std::pmr::memory_resource* {
+        return resource_;
+    }
+
+    template<typename U>
+    [[nodiscard]] friend constexpr bool operator==(const resource_allocator& a,
+                                                   const resource_allocator<U>& b) noexcept {
+        if (a.resource() == b.resource()) return true;
+        return a.resource() != nullptr and b.resource() != nullptr
+               and a.resource()->is_equal(*b.resource());
+    }
 };
 
+/// Vector which elements are allocated with resource_allocator.
+template<typename T>
+using resource_vector = std::vector<T, resource_allocator<T>>;
+
 /// Helper for creating function objects.
 template<class... Ts>
 struct overloaded : Ts... {
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <array>
+#include <bit>
 #include <concepts>
-#include <optional>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
-#include <variant>
+#include <utility>
 
 namespace hycc {
 namespace state_pattern_matcher {
@@ -13,6 +17,7 @@ struct predicate_tag {};
 struct begin_tag {};
 struct continuation_tag {};
 struct end_tag {};
+struct consume_tag {};
 
 template<typename P, typename S>
 concept pattern_for = requires(P p, S s) {
@@ -22,6 +27,38 @@ concept pattern_for = requires(P p, S s) {
     { p(end_tag{}, s) } -> std::same_as<void>;
 };
 
+/// Pattern which declares the code units it can begin at.
+///
+/// `P::can_start_with(c)` has to be true for every code unit \p c,
+/// for which the predicate of P can be true, when P is not being matched.
+template<typename P>
+concept declares_start_chars = requires(const unsigned char c) {
+    { std::remove_cvref_t<P>::can_start_with(c) } -> std::same_as<bool>;
+};
+
+/// Pattern which can tell how many code units it covers at once.
+///
+/// `p(consume_tag{}, s)` is called after begin and after each continuation of \p P.
+/// It returns how many code units, starting from the current one, belong to \p P
+/// before its predicate has to be evaluated again. It has to be at least one
+/// and must not step over the state where until predicate of the matcher becomes true.
+template<typename P, typename S>
+concept consumes_runs = requires(P p, S s) {
+    { p(consume_tag{}, s) } -> std::same_as<std::size_t>;
+};
+
+/// State which can be advanced many code units at once.
+template<typename S>
+concept bulk_advanceable_state = requires(S s, const std::size_t n) {
+    { s.advance_by(n) } -> std::same_as<void>;
+};
+
+/// State which can tell the code unit a pattern would begin at.
+template<typename S>
+concept peekable_state = requires(const S& s) {
+    { s.peek() } -> std::convertible_to<unsigned char>;
+};
+
 /// \p P... are types of function object which reprsesnt different patterns in the state.
 ///
 /// State is of user spesified type \p S, which can be advanced `S::advance() -> void`.
@@ -36,34 +73,91 @@ concept pattern_for = requires(P p, S s) {
 /// matcher_t uses these in matcher_t::operator()(initial_state, until_predicate).
 /// Predicate of patterns determine if the pattern matches that state.
 ///
+/// If \p S is peekable_state, patterns which are declares_start_chars are only tried
+/// at the code units they can begin at. Which patterns to try is looked up from a table
+/// built at compile time, so most predicates are not evaluated at all.
+///
+/// Patterns which are consumes_runs are advanced over their runs without evaluating
+/// predicate or calling continuation for each code unit of the run.
+/// If \p S has `S::advance_by(std::size_t) -> void`, it is used to advance over the runs.
+///
 template<typename S, pattern_for<S>... P>
     requires std::same_as<S, std::remove_cvref_t<S>>
 class matcher_t {
     using patterns_t = std::tuple<std::remove_cvref_t<P>...>;
     patterns_t patterns_;
 
-    using pattern_variant = std::variant<std::reference_wrapper<std::remove_cvref_t<P>>...>;
+    static_assert(sizeof...(P) <= 64, "Candidate patterns are stored in 64 bit mask.");
+    using candidate_mask = std::uint64_t;
 
-    /// Finds first pattern thats predicate is true. Throws if none found.
-    constexpr auto find_pattern(const S& state) -> pattern_variant {
-        auto found = std::optional<pattern_variant>{};
+    static constexpr auto all_patterns = ~candidate_mask{ 0 } >> (64 - sizeof...(P));
 
-        auto helper = [&]<std::size_t I>() -> bool {
-            if (std::get<I>(patterns_)(predicate_tag{}, state)) {
-                found = std::ref(std::get<I>(patterns_));
-                return false;
+    /// Patterns which can begin at a code unit, indexed by the code unit.
+    static constexpr auto candidates_by_char = [] {
+        auto table = std::array<candidate_mask, 256>{};
+        auto add   = [&]<std::size_t I, typename Pattern>() {
+            for (auto c = 0uz; c < table.size(); ++c) {
+                if constexpr (declares_start_chars<Pattern>) {
+                    if (not Pattern::can_start_with(static_cast<unsigned char>(c))) continue;
+                }
+                table[c] |= candidate_mask{ 1 } << I;
             }
-            return true;
         };
-
         [&]<std::size_t... I>(std::index_sequence<I...>) {
-            // Will short circuit, helper returns true until not.
-            // This syntax is weird...
-            ((helper.template operator()<I>()) and ...);
+            (add.template operator()<I, std::remove_cvref_t<P>>(), ...);
         }(std::make_index_sequence<sizeof...(P)>());
+        return table;
+    }();
+
+    /// Jump tables calling pattern with given index, used instead of variant visitation.
+    static constexpr auto predicate_table = []<std::size_t... I>(std::index_sequence<I...>) {
+        using predicate_ptr = bool (*)(patterns_t&, S&);
+        return std::array<predicate_ptr, sizeof...(P)>{ [](patterns_t& patterns, S& state) {
+            return std::get<I>(patterns)(predicate_tag{}, state);
+        }... };
+    }(std::make_index_sequence<sizeof...(P)>());
+
+    template<typename Tag>
+    static constexpr auto tag_table = []<std::size_t... I>(std::index_sequence<I...>) {
+        using tag_ptr = void (*)(patterns_t&, S&);
+        return std::array<tag_ptr, sizeof...(P)>{ [](patterns_t& patterns, S& state) {
+            std::get<I>(patterns)(Tag{}, state);
+        }... };
+    }(std::make_index_sequence<sizeof...(P)>());
+
+    /// Length of run which pattern covers, one for patterns which are not consumes_runs.
+    static constexpr auto consume_table = []<std::size_t... I>(std::index_sequence<I...>) {
+        using consume_ptr = std::size_t (*)(patterns_t&, S&);
+        return std::array<consume_ptr, sizeof...(P)>{ [](patterns_t& patterns, S& state) {
+            if constexpr (consumes_runs<std::tuple_element_t<I, patterns_t>, S>) {
+                return std::get<I>(patterns)(consume_tag{}, state);
+            } else {
+                return 1uz;
+            }
+        }... };
+    }(std::make_index_sequence<sizeof...(P)>());
+
+    static constexpr void advance_state(S& state, const std::size_t n) {
+        if constexpr (bulk_advanceable_state<S>) {
+            state.advance_by(n);
+        } else {
+            for (auto i = 0uz; i < n; ++i) state.advance();
+        }
+    }
+
+    /// Finds index of first pattern thats predicate is true. Throws if none found.
+    constexpr auto find_pattern(S& state) -> std::size_t {
+        auto candidates = all_patterns;
+        if constexpr (peekable_state<S>) {
+            candidates = candidates_by_char[static_cast<unsigned char>(state.peek())];
+        }
 
-        // Throws if not found.
-        return found.value();
+        // Lowest bit is the first pattern, so patterns are tried in order.
+        for (; candidates != 0; candidates &= candidates - 1) {
+            const auto i = static_cast<std::size_t>(std::countr_zero(candidates));
+            if (predicate_table[i](patterns_, state)) return i;
+        }
+        throw std::logic_error{ "None of the patterns match the state!" };
     }
 
   public:
@@ -77,7 +171,7 @@ class matcher_t {
     ///     2) Find first pattern p which predicate is true.
     ///         - Throws if none of the predicates is true.
     ///     3) Call begin of p.
-    ///     4) Advance \p current_state.
+    ///     4) Advance \p current_state over the run consumed by p (one if p does not consume).
     ///     5) If until_predicate(current_state) is true:
     ///         - Call end of p.
     ///         - Return current_state.
@@ -94,39 +188,37 @@ class matcher_t {
         // Check if there is nothing to do.
         if (until_predicate(current_state)) return current_state;
 
-        pattern_variant pattern_found = find_pattern(current_state);
+        auto pattern_found = find_pattern(current_state);
 
         auto is_predicate_true = [&]() -> bool {
-            return std::visit([&](auto pat) -> bool { return pat(predicate_tag{}, current_state); },
-                              pattern_found);
+            return predicate_table[pattern_found](patterns_, current_state);
         };
 
         auto tagged_call = [&]<typename Tag>(Tag) {
-            std::visit([&](auto pat) -> void { pat(Tag{}, current_state); }, pattern_found);
+            tag_table<Tag>[pattern_found](patterns_, current_state);
         };
 
-        goto jump_start;
-
-    next_round:
-        current_state.advance();
-        if (until_predicate(current_state)) {
-            tagged_call(end_tag{});
-            return current_state;
-        }
+        // Loop instead of goto, so that matching can be evaluated at compile time.
+        tagged_call(begin_tag{});
+        for (;;) {
+            advance_state(current_state, consume_table[pattern_found](patterns_, current_state));
+            if (until_predicate(current_state)) {
+                tagged_call(end_tag{});
+                return current_state;
+            }
 
-        if (is_predicate_true()) {
-            // Continuing previous pattern.
-            tagged_call(continuation_tag{});
-        } else {
-            // End of previous pattern.
-            tagged_call(end_tag{});
+            if (is_predicate_true()) {
+                // Continuing previous pattern.
+                tagged_call(continuation_tag{});
+            } else {
+                // End of previous pattern.
+                tagged_call(end_tag{});
 
-            // Time to find new pattern.
-            pattern_found = find_pattern(current_state);
-        jump_start:
-            tagged_call(begin_tag{});
+                // Time to find new pattern.
+                pattern_found = find_pattern(current_state);
+                tagged_call(begin_tag{});
+            }
         }
-        goto next_round;
     }
 };
 
@@ -0,0 +1,212 @@
+#pragma once
+
+/// @file Symbol ids of keywords, operators and interned identifiers.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace hycc {
+
+/// Identifies text of a token, so that tokens can be compared without their text.
+///
+/// Ids are split to ranges:
+///
+///     - [0, 128): single character tokens, id is the code unit
+///     - [first_keyword_id, first_operator_id): keywords in the order of hycc::keywords
+///     - [first_operator_id, first_identifier_id): multi character operators
+///       in the order of hycc::multi_character_operators
+///     - [first_identifier_id, ...): identifiers interned to a symbol_table
+using symbol_id = std::uint32_t;
+
+/// Id of a token which text is not identified, e.g. whitespace or literal.
+inline constexpr auto no_symbol = std::numeric_limits<symbol_id>::max();
+
+inline constexpr auto keywords = std::array<std::u8string_view, 7>{
+    u8"in", u8"inout", u8"out", u8"move", u8"copy", u8"forward", u8"const"
+};
+
+/// Operators which are single tokens when tokenized with operator_mode::maximal_munch.
+///
+/// Ordered from the longest to the shortest, so the first one matching is the longest match.
+/// Characters of an operator are all of the same character class.
+inline constexpr auto multi_character_operators = std::array<std::u8string_view, 23>{
+    u8"<=>", u8"<<=", u8">>=", u8"::", u8"->", u8"++", u8"--", u8"<<",
+    u8">>",  u8"<=",  u8">=",  u8"==", u8"!=", u8"&&", u8"||", u8"+=",
+    u8"-=",  u8"*=",  u8"/=",  u8"%=", u8"&=", u8"^=", u8"|="
+};
+
+inline constexpr auto first_keyword_id    = symbol_id{ 128 };
+inline constexpr auto first_operator_id   = first_keyword_id + symbol_id{ keywords.size() };
+inline constexpr auto first_identifier_id =
+    first_operator_id + symbol_id{ multi_character_operators.size() };
+
+namespace detail {
+
+struct keyword_hash_t {
+    std::size_t multiplier;
+    std::size_t table_size;
+
+    [[nodiscard]] constexpr auto operator()(const std::u8string_view str) const -> std::size_t {
+        return (str.front() * multiplier + str.back() + str.size()) % table_size;
+    }
+};
+
+/// Smallest keyword_hash_t, which is perfect hash for the keywords.
+inline constexpr auto keyword_hash = [] {
+    for (auto table_size = keywords.size(); table_size <= 4 * keywords.size(); ++table_size) {
+        for (auto multiplier = 1uz; multiplier < 256uz; ++multiplier) {
+            const auto hash = keyword_hash_t{ multiplier, table_size };
+            auto used       = std::vector<bool>(table_size, false);
+            auto perfect    = true;
+            for (const auto keyword : keywords) {
+                perfect = perfect and not used[hash(keyword)];
+                used[hash(keyword)] = true;
+            }
+            if (perfect) return hash;
+        }
+    }
+    throw std::logic_error{ "No perfect hash found for the keywords!" };
+}();
+
+/// Index to keywords by keyword_hash, or keywords.size() if the slot is empty.
+inline constexpr auto keyword_slots = [] {
+    auto slots = std::array<std::size_t, keyword_hash.table_size>{};
+    slots.fill(keywords.size());
+    for (auto i = 0uz; i < keywords.size(); ++i) slots[keyword_hash(keywords[i])] = i;
+    return slots;
+}();
+
+/// Text of single character symbols, indexed by the symbol id.
+inline constexpr auto single_characters = [] {
+    auto chars = std::array<char8_t, first_keyword_id>{};
+    for (auto i = 0uz; i < chars.size(); ++i) chars[i] = static_cast<char8_t>(i);
+    return chars;
+}();
+
+} // namespace detail
+
+/// Id of \p str if it is a keyword.
+[[nodiscard]] constexpr auto keyword_id(const std::u8string_view str) -> std::optional<symbol_id> {
+    if (str.empty()) return {};
+    const auto i = detail::keyword_slots[detail::keyword_hash(str)];
+    if (i == keywords.size() or keywords[i] != str) return {};
+    return first_keyword_id + static_cast<symbol_id>(i);
+}
+
+/// Id of \p str if it is a multi character operator.
+[[nodiscard]] constexpr auto multi_character_operator_id(const std::u8string_view str)
+    -> std::optional<symbol_id> {
+    if (str.size() < 2 or str.size() > 3) return {};
+    const auto it = std::ranges::find(multi_character_operators, str);
+    if (it == multi_character_operators.end()) return {};
+    return first_operator_id + static_cast<symbol_id>(it - multi_character_operators.begin());
+}
+
+/// Id of \p str if it is a keyword, a multi character operator or a single character,
+/// i.e. its id does not depend on a symbol_table.
+[[nodiscard]] constexpr auto fixed_symbol_id(const std::u8string_view str) -> symbol_id {
+    if (str.size() == 1 and str.front() < first_keyword_id) return symbol_id{ str.front() };
+    if (const auto id = keyword_id(str)) return id.value();
+    return multi_character_operator_id(str).value_or(no_symbol);
+}
+
+/// FNV-1a hash.
+[[nodiscard]] constexpr auto hash_symbol(const std::u8string_view str) -> std::uint64_t {
+    auto hash = std::uint64_t{ 14695981039346656037u };
+    for (const auto c : str) {
+        hash ^= c;
+        hash *= std::uint64_t{ 1099511628211u };
+    }
+    return hash;
+}
+
+/// Interns identifiers to ids, which are given in the order of first occurrence.
+///
+/// Stores the text of the identifiers, so it does not refer to any source code.
+class symbol_table {
+    struct slot {
+        std::uint64_t hash;
+        symbol_id id = no_symbol;
+    };
+    /// Open addressing with linear probing, size is power of two.
+    std::vector<slot> slots_ = std::vector<slot>(16);
+
+    std::u8string names_{};
+    /// Offsets to names_, where name of the identifier begins, followed by size of names_.
+    std::vector<std::size_t> name_offsets_ = { 0 };
+
+    [[nodiscard]] constexpr auto identifier_count() const noexcept -> std::size_t {
+        return name_offsets_.size() - 1;
+    }
+
+    [[nodiscard]] constexpr auto identifier_name(const std::size_t i) const -> std::u8string_view {
+        return std::u8string_view{ names_ }.substr(name_offsets_[i],
+                                                   name_offsets_[i + 1] - name_offsets_[i]);
+    }
+
+    /// Slot of \p str, which is either empty or contains the id of \p str.
+    [[nodiscard]] constexpr auto find_slot(const std::u8string_view str,
+                                           const std::uint64_t hash) -> slot& {
+        const auto mask = slots_.size() - 1;
+        for (auto i = static_cast<std::size_t>(hash) & mask;; i = (i + 1) & mask) {
+            auto& s = slots_[i];
+            if (s.id == no_symbol) return s;
+            if (s.hash == hash and identifier_name(s.id - first_identifier_id) == str) return s;
+        }
+    }
+
+    constexpr void grow() {
+        auto old = std::exchange(slots_, std::vector<slot>(2 * slots_.size()));
+        for (const auto& s : old) {
+            if (s.id == no_symbol) continue;
+            find_slot(identifier_name(s.id - first_identifier_id), s.hash) = s;
+        }
+    }
+
+  public:
+    /// Id of \p str, which is interned if its id is not fixed_symbol_id.
+    [[nodiscard]] constexpr auto intern(const std::u8string_view str) -> symbol_id {
+        if (const auto id = fixed_symbol_id(str); id != no_symbol) return id;
+        return intern_identifier(str, hash_symbol(str));
+    }
+
+    /// Id of identifier \p str, which hash is \p hash and which is not a keyword.
+    [[nodiscard]] constexpr auto intern_identifier(const std::u8string_view str,
+                                                   const std::uint64_t hash) -> symbol_id {
+        // Keep load factor at most 1/2.
+        if (2 * (identifier_count() + 1) > slots_.size()) grow();
+
+        auto& s = find_slot(str, hash);
+        if (s.id != no_symbol) return s.id;
+
+        s = { hash, first_identifier_id + static_cast<symbol_id>(identifier_count()) };
+        names_.append(str);
+        name_offsets_.push_back(names_.size());
+        return s.id;
+    }
+
+    /// Text of the symbol \p id.
+    [[nodiscard]] constexpr auto name(const symbol_id id) const -> std::u8string_view {
+        if (id < first_keyword_id) return { &detail::single_characters[id], 1 };
+        if (id < first_operator_id) return keywords[id - first_keyword_id];
+        if (id < first_identifier_id) return multi_character_operators[id - first_operator_id];
+        if (id - first_identifier_id >= identifier_count()) {
+            throw std::out_of_range{ "Symbol is not in the symbol table!" };
+        }
+        return identifier_name(id - first_identifier_id);
+    }
+
+    /// Number of interned identifiers.
+    [[nodiscard]] constexpr auto size() const noexcept -> std::size_t { return identifier_count(); }
+};
+
+} // namespace hycc
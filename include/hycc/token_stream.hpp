@@ -0,0 +1,554 @@
+#pragma once
+
+/// @file Tokenizer which reads source code in chunks from a file descriptor.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "hycc/char_class.hpp"
+#include "hycc/line_index.hpp"
+#include "hycc/tokenizer.hpp"
+
+namespace hycc {
+
+/// Token read from token_stream.
+///
+/// Refers to the source code of the stream directly,
+/// so its text is valid only until the next token is read.
+struct stream_token {
+    token_type type;
+    bool preceded_by_whitespace;
+    /// Byte offset of the first character of the token in the whole stream.
+    std::uint64_t offset;
+    source_position position;
+    std::u8string_view sv;
+    /// Symbol in token_stream::symbols().
+    symbol_id symbol;
+};
+
+/// Problem found by the tokenizer in code units [offset, offset + length) of the whole stream.
+struct stream_diagnostic {
+    diagnostic_kind kind;
+    std::uint64_t offset;
+    std::uint32_t length;
+
+    [[nodiscard]] friend constexpr bool operator==(const stream_diagnostic&,
+                                                   const stream_diagnostic&) = default;
+};
+
+/// Tokens of a top level unit of token_stream, see token_stream::next_unit.
+struct stream_unit {
+    /// Tokens, which offsets and positions are relative to the beginning of the unit.
+    token_buffer tokens;
+    /// Byte offset of the first token of the unit in the whole stream.
+    std::uint64_t offset;
+    /// Position of the first token of the unit in the whole stream.
+    source_position position;
+};
+
+/// Pull based tokenizer, which reads source code from a file descriptor in chunks.
+///
+/// Produces the same tokens as tokenize, but keeps in memory only the latest chunk
+/// and the token which might continue in the next chunk. Comments and, in
+/// trivia_mode::side_table, whitespace are not emitted, so they are discarded while they are
+/// read. Peak memory is bounded by the chunk size and the length of the longest emitted token.
+///
+/// Token which continues in the next chunk is not tokenized again before its end is read.
+/// Its end is found by scanning only the code units read after it,
+/// so every code unit is scanned a constant number of times.
+///
+/// Does not own the file descriptor.
+class token_stream {
+    /// How the token at the end of the read code units continues in the next chunk.
+    class continuation {
+      public:
+        enum class kind : std::uint8_t {
+            /// Token has ended, or is at most a few code units long,
+            /// so it is tokenized again with the next chunk.
+            rescan,
+            /// Run of char_run, see hycc::run_length.
+            run,
+            line_comment,
+            block_comment,
+            /// Literal, which begins with a single delimiter and can contain escapes.
+            escaped_literal,
+            /// Literal, which begins and ends with three delimiters.
+            raw_literal
+        };
+
+      private:
+        kind kind_         = kind::rescan;
+        token_type type_   = token_type::whitespace;
+        char_run run_      = char_run::whitespace;
+        char8_t delimiter_ = 0;
+        /// Window offset where scanning for the end continues.
+        std::size_t resume_ = 0;
+
+        /// Run of code units, which tokens of \p type consist of after their first code unit.
+        [[nodiscard]] static constexpr auto run_of(const token_type type)
+            -> std::optional<char_run> {
+            switch (type) {
+                case token_type::whitespace: return char_run::whitespace;
+                case token_type::integer: return char_run::integer;
+                case token_type::identifier: return char_run::id_continuation;
+                case token_type::error: return char_run::other;
+                default: return {};
+            }
+        }
+
+      public:
+        /// Continuation of nothing, which ends at the beginning of the window.
+        [[nodiscard]] continuation() = default;
+
+        /// Continuation of token \p t, which begins at \p from and reaches the end of \p window.
+        ///
+        /// \p unterminated tells if the tokenizer reached the end of \p window
+        /// inside a literal or a block comment.
+        [[nodiscard]] continuation(const token& t,
+                                   const std::u8string_view window,
+                                   const std::size_t from,
+                                   const bool unterminated)
+            : type_{ t.type },
+              resume_{ window.size() } {
+            const auto text = window.substr(from);
+            if (const auto run = run_of(t.type)) {
+                kind_ = kind::run;
+                run_  = run.value();
+            } else if (t.type == token_type::comment) {
+                if (text[1] == u8'/' and text.back() != u8'\n') kind_ = kind::line_comment;
+                if (text[1] == u8'*' and unterminated) {
+                    kind_   = kind::block_comment;
+                    resume_ = std::max(from + 2, window.size() - 1);
+                }
+            } else if (t.type == token_type::literal and unterminated and text.size() >= 3) {
+                // Shorter literal might still become a raw literal.
+                delimiter_ = text.front();
+                if (text[1] == delimiter_ and text[2] == delimiter_) {
+                    kind_   = kind::raw_literal;
+                    resume_ = std::max(from + 3, window.size() - 2);
+                } else {
+                    kind_ = kind::escaped_literal;
+                    // Odd number of backslashes at the end escapes the next code unit.
+                    const auto backslashes =
+                        text.size() - 1 - text.find_last_not_of(u8'\\', text.size() - 1);
+                    resume_ += backslashes % 2;
+                }
+            }
+        }
+
+        [[nodiscard]] auto get_kind() const noexcept -> kind { return kind_; }
+        [[nodiscard]] auto type() const noexcept -> token_type { return type_; }
+
+        /// Window offset until which the code units have been scanned without finding the end.
+        [[nodiscard]] auto scanned() const noexcept -> std::size_t { return resume_; }
+
+        /// Adjusts to \p n code units being erased from the beginning of the window.
+        void shift(const std::size_t n) noexcept { resume_ -= std::min(resume_, n); }
+
+        /// Window offset one past the end of the token, or nullopt if it continues past \p window.
+        ///
+        /// Scans only the code units which were not scanned by the previous call.
+        [[nodiscard]] auto end_in(const std::u8string_view window) -> std::optional<std::size_t> {
+            switch (kind_) {
+                case kind::rescan: return resume_;
+                case kind::run: {
+                    resume_ += run_length(run_, window.substr(resume_));
+                    if (resume_ < window.size()) return resume_;
+                    return {};
+                }
+                case kind::line_comment: {
+                    const auto newline = window.find(u8'\n', resume_);
+                    if (newline != std::u8string_view::npos) return newline + 1;
+                    resume_ = window.size();
+                    return {};
+                }
+                case kind::block_comment: {
+                    const auto delimiter = window.find(u8"*/", resume_);
+                    if (delimiter != std::u8string_view::npos) return delimiter + 2;
+                    // Delimiter might begin at the last code unit.
+                    resume_ = std::max(resume_, window.size() - 1);
+                    return {};
+                }
+                case kind::escaped_literal: {
+                    while (resume_ < window.size()) {
+                        resume_ += find_either(window.substr(resume_), delimiter_, u8'\\');
+                        if (resume_ == window.size()) break;
+                        if (window[resume_] == delimiter_) return resume_ + 1;
+                        // Escape next code unit after backslash.
+                        resume_ += 2;
+                    }
+                    return {};
+                }
+                case kind::raw_literal: {
+                    for (; resume_ + 3 <= window.size(); ++resume_) {
+                        resume_ += find_either(window.substr(resume_), delimiter_, delimiter_);
+                        if (resume_ + 3 > window.size()) break;
+                        if (window[resume_ + 1] == delimiter_ and window[resume_ + 2] == delimiter_)
+                            return resume_ + 3;
+                    }
+                    return {};
+                }
+            }
+            return resume_;
+        }
+    };
+
+    int fd_;
+    trivia_mode mode_;
+    operator_mode operators_;
+    std::size_t chunk_size_;
+    /// Resource of the token buffers of the units.
+    std::pmr::memory_resource* resource_;
+    bool end_of_file_ = false;
+
+    /// Source code which is not yet discarded, starting at offset window_offset_ of the stream.
+    std::u8string window_{};
+    std::uint64_t window_offset_ = 0;
+
+    /// Tokens of the window which can be emitted, with offsets relative to the window.
+    std::vector<token> ready_{};
+    std::size_t next_ready_ = 0;
+    /// Diagnostics of the ready tokens, with offsets relative to the window.
+    std::vector<tokenizer_diagnostic> ready_diagnostics_{};
+    std::size_t next_ready_diagnostic_ = 0;
+
+    /// Window offset of the token or trivia which might continue in the next chunk.
+    std::size_t held_back_from_            = 0;
+    bool held_back_preceded_by_whitespace_ = false;
+    continuation held_back_{};
+
+    /// Window offset of the first token of the unit being read by next_unit.
+    ///
+    /// Code units of the unit are not discarded, as the tokens of the unit refer to them.
+    std::optional<std::size_t> unit_from_{};
+
+    /// Newlines of the window before this offset are counted to row_.
+    std::size_t counted_until_  = 0;
+    std::size_t row_            = 0;
+    std::uint64_t last_newline_ = 0;
+
+    /// Symbols of the whole stream, as windows are tokenized with their own symbol tables.
+    symbol_table symbols_{};
+    std::vector<stream_diagnostic> diagnostics_{};
+
+    void count_newlines_until(const std::size_t window_pos) {
+        for (; counted_until_ < window_pos; ++counted_until_) {
+            if (window_[counted_until_] == u8'\n') {
+                ++row_;
+                last_newline_ = window_offset_ + counted_until_;
+            }
+        }
+    }
+
+    /// Discards \p n code units from the beginning of the window.
+    void discard(const std::size_t n) {
+        count_newlines_until(n);
+        window_.erase(0, n);
+        window_offset_ += n;
+        counted_until_ -= n;
+        held_back_from_ -= std::min(held_back_from_, n);
+        held_back_.shift(n);
+        if (unit_from_) unit_from_ = unit_from_.value() - std::min(unit_from_.value(), n);
+    }
+
+    void read_chunk() {
+        const auto old_size = window_.size();
+        window_.resize(old_size + chunk_size_);
+
+        auto n = ::read(fd_, window_.data() + old_size, chunk_size_);
+        while (n < 0 and errno == EINTR) n = ::read(fd_, window_.data() + old_size, chunk_size_);
+        if (n < 0) {
+            const auto error = errno;
+            window_.resize(old_size);
+            throw std::system_error{ error, std::generic_category(), "token_stream read failed" };
+        }
+
+        window_.resize(old_size + static_cast<std::size_t>(n));
+        end_of_file_ = n == 0;
+    }
+
+    /// Held back trivia is not emitted, so it is discarded instead of tokenized.
+    ///
+    /// Trivia which has already ended is at most a chunk long, so it is tokenized again.
+    [[nodiscard]] bool discards_held_back() const noexcept {
+        if (unit_from_ or held_back_.get_kind() == continuation::kind::rescan) return false;
+        const auto type = held_back_.type();
+        return type == token_type::comment
+               or (type == token_type::whitespace and mode_ == trivia_mode::side_table);
+    }
+
+    /// Tokenizes the window from the held back token.
+    void tokenize_window() {
+        if (window_.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error{ "Token is too large to be tokenized!" };
+        }
+        const auto unread = std::u8string_view{ window_ }.substr(held_back_from_);
+        const auto base   = static_cast<std::uint32_t>(held_back_from_);
+        auto state        = run_tokenizer(unread, trivia_mode::side_table, operators_);
+
+        // Token which was held back is tokenized again at the beginning of the unread code units.
+        auto continue_held_back = [&](std::vector<token>& v) {
+            if (not v.empty() and v.front().offset == 0)
+                v.front().preceded_by_whitespace |= held_back_preceded_by_whitespace_;
+        };
+        continue_held_back(state.tokens);
+        continue_held_back(state.trivia);
+
+        // Tokens and trivia cover the unread code units, so the last one of them ends at the end
+        // of the window. It might continue in the next chunk, so hold it back, unless at the end.
+        // Every prefix of a multi character operator is an operator, so an operator continuing
+        // in the next chunk changes only the last token.
+        auto ready_until = unread.size();
+        if (not end_of_file_ and not (state.tokens.empty() and state.trivia.empty())) {
+            const auto last_trivia =
+                not state.trivia.empty()
+                and (state.tokens.empty() or state.trivia.back().offset > state.tokens.back().offset);
+            const auto last = last_trivia ? state.trivia.back() : state.tokens.back();
+            ready_until                       = last.offset;
+            held_back_preceded_by_whitespace_ = last.preceded_by_whitespace;
+            held_back_ = continuation{ last, window_, base + last.offset, state.unterminated };
+        }
+        held_back_from_ = base + ready_until;
+
+        ready_.clear();
+        next_ready_ = 0;
+        auto is_ready      = [&](const auto& t) { return t.offset < ready_until; };
+        auto is_whitespace = [](const token& t) { return t.type == token_type::whitespace; };
+        auto rebased       = [&](auto t) {
+            t.offset += base;
+            return t;
+        };
+
+        auto significant = state.tokens | std::views::take_while(is_ready);
+        if (mode_ == trivia_mode::side_table) {
+            std::ranges::copy(significant | std::views::transform(rebased),
+                              std::back_inserter(ready_));
+        } else {
+            auto whitespace =
+                state.trivia | std::views::take_while(is_ready) | std::views::filter(is_whitespace);
+            std::ranges::merge(significant | std::views::transform(rebased),
+                               whitespace | std::views::transform(rebased),
+                               std::back_inserter(ready_),
+                               {},
+                               &token::offset,
+                               &token::offset);
+        }
+
+        ready_diagnostics_.clear();
+        next_ready_diagnostic_ = 0;
+        std::ranges::copy(state.diagnostics | std::views::take_while(is_ready)
+                              | std::views::transform(rebased),
+                          std::back_inserter(ready_diagnostics_));
+    }
+
+    /// Reads chunks until there are tokens ready or the stream has ended.
+    void refill() {
+        discard(unit_from_.value_or(held_back_from_));
+
+        do {
+            if (not end_of_file_) read_chunk();
+            const auto end = held_back_.end_in(window_);
+            if (discards_held_back()) {
+                if (end) {
+                    discard(end.value());
+                    // Trivia has ended, so the token after it is preceded by whitespace.
+                    held_back_preceded_by_whitespace_ = true;
+                    held_back_                        = {};
+                } else {
+                    discard(end_of_file_ ? window_.size() : held_back_.scanned());
+                }
+            }
+            if (not end and not end_of_file_) continue;
+            tokenize_window();
+        } while (next_ready_ == ready_.size() and not end_of_file_);
+    }
+
+    /// Next ready token, which offset is relative to the window, or nullptr at the end.
+    [[nodiscard]] auto next_ready() -> const token* {
+        if (next_ready_ == ready_.size()) {
+            if (end_of_file_ and held_back_from_ == window_.size()) return nullptr;
+            refill();
+            if (next_ready_ == ready_.size()) return nullptr;
+        }
+
+        const auto& t = ready_[next_ready_++];
+        count_newlines_until(t.offset + 1);
+        for (; next_ready_diagnostic_ < ready_diagnostics_.size(); ++next_ready_diagnostic_) {
+            const auto& d = ready_diagnostics_[next_ready_diagnostic_];
+            if (d.offset >= t.offset + t.length) break;
+            diagnostics_.push_back(
+                { .kind = d.kind, .offset = window_offset_ + d.offset, .length = d.length });
+        }
+        return &t;
+    }
+
+    /// Position of the token at \p window_pos, after the newlines before it are counted.
+    [[nodiscard]] auto position_at(const std::size_t window_pos) const -> source_position {
+        const auto offset = window_offset_ + window_pos;
+        // On the first row there is "virtual newline" before the source.
+        if (row_ == 0) return { 0, offset + 1 };
+        return { row_, offset - last_newline_ };
+    }
+
+  public:
+    static constexpr auto default_chunk_size = 64uz * 1024uz;
+
+    /// Reads source code from \p fd in chunks of \p chunk_size code units,
+    /// which is tokenized with trivia handled as in \p mode and operators as in \p operators.
+    ///
+    /// Token buffers of the units read with next_unit are allocated from \p resource,
+    /// or with std::allocator if it is nullptr.
+    [[nodiscard]] explicit token_stream(
+        const int fd,
+        const trivia_mode mode                    = trivia_mode::in_stream,
+        const operator_mode operators             = operator_mode::single_character,
+        const std::size_t chunk_size              = default_chunk_size,
+        std::pmr::memory_resource* const resource = nullptr)
+        : fd_{ fd },
+          mode_{ mode },
+          operators_{ operators },
+          chunk_size_{ chunk_size },
+          resource_{ resource } {
+        if (chunk_size_ == 0) throw std::invalid_argument{ "token_stream chunk size is 0!" };
+    }
+
+    /// Reads next token or nullopt if the stream has ended.
+    ///
+    /// Invalidates text of the previously read token.
+    [[nodiscard]] auto next() -> std::optional<stream_token> {
+        const auto* const t = next_ready();
+        if (t == nullptr) return {};
+
+        const auto sv = std::u8string_view{ window_ }.substr(t->offset, t->length);
+        // Identifier symbols of the window are not the symbols of the stream.
+        auto symbol = t->symbol;
+        if (symbol != no_symbol and symbol >= first_identifier_id) symbol = symbols_.intern(sv);
+
+        return stream_token{ .type                   = t->type,
+                             .preceded_by_whitespace = t->preceded_by_whitespace,
+                             .offset                 = window_offset_ + t->offset,
+                             .position               = position_at(t->offset),
+                             .sv                     = sv,
+                             .symbol                 = symbol };
+    }
+
+    /// Reads tokens until semantic scope operator ; or } which is not inside {},
+    /// so that parser_t can parse the stream one unit at a time.
+    ///
+    /// Tokens of the unit are given as a token_buffer, which owns a copy of the source code
+    /// from the first to the last token of the unit and has symbols of its own.
+    /// Returns nullopt if the stream has ended. Last unit ends at the end of the stream.
+    [[nodiscard]] auto next_unit() -> std::optional<stream_unit> {
+        const auto* t = next_ready();
+        if (t == nullptr) return {};
+
+        const auto offset           = window_offset_ + t->offset;
+        const auto position         = position_at(t->offset);
+        const auto first_diagnostic = diagnostics_.size();
+        unit_from_                  = t->offset;
+
+        auto tokens  = sstd::resource_vector<token>(resource_);
+        auto symbols = symbol_table{};
+        auto depth   = 0uz;
+        auto end     = offset;
+        for (; t != nullptr; t = next_ready()) {
+            const auto token_end = window_offset_ + t->offset + t->length;
+            if (token_end - offset > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::length_error{ "Unit is too large to be tokenized!" };
+            }
+            end = token_end;
+
+            auto& u  = tokens.emplace_back(*t);
+            u.offset = static_cast<std::uint32_t>(window_offset_ + t->offset - offset);
+            if (u.symbol != no_symbol and u.symbol >= first_identifier_id) {
+                const auto sv = std::u8string_view{ window_ }.substr(t->offset, t->length);
+                u.symbol      = symbols.intern(sv);
+            }
+
+            if (u.type != token_type::semantic_scope_operator) continue;
+            if (u.symbol == symbol_id{ u8'{' }) ++depth;
+            const auto closes = u.symbol == symbol_id{ u8'}' };
+            if (closes and depth != 0) --depth;
+            if (depth == 0 and (closes or u.symbol == symbol_id{ u8';' })) break;
+        }
+
+        const auto from = static_cast<std::size_t>(offset - window_offset_);
+        auto text       = std::u8string{ std::u8string_view{ window_ }.substr(from, end - offset) };
+        unit_from_.reset();
+
+        auto diagnostics = sstd::resource_vector<tokenizer_diagnostic>(resource_);
+        for (const auto& d : std::span{ diagnostics_ }.subspan(first_diagnostic)) {
+            diagnostics.push_back({ .kind   = d.kind,
+                                    .offset = static_cast<std::uint32_t>(d.offset - offset),
+                                    .length = d.length });
+        }
+
+        auto source = source_code{ std::move(text) };
+        return stream_unit{ .tokens   = token_buffer{ source.get_ownership_of_code(),
+                                                    std::move(tokens),
+                                                    sstd::resource_vector<token>(resource_),
+                                                    mode_,
+                                                    std::move(symbols),
+                                                    operators_,
+                                                    std::move(diagnostics) },
+                            .offset   = offset,
+                            .position = position };
+    }
+
+    /// Symbols of the tokens read so far with next.
+    [[nodiscard]] auto symbols() const noexcept -> const symbol_table& { return symbols_; }
+
+    /// Problems found by the tokenizer in the tokens read so far, in the order of their offsets.
+    [[nodiscard]] auto diagnostics() const noexcept -> std::span<stream_diagnostic const> {
+        return diagnostics_;
+    }
+
+    /// Number of code units of the source code held in memory.
+    [[nodiscard]] auto buffered() const noexcept -> std::size_t { return window_.size(); }
+
+    /// Input iterator reading the tokens of token_stream.
+    class iterator {
+        token_stream* stream_ = nullptr;
+        std::optional<stream_token> current_{};
+
+      public:
+        using value_type      = stream_token;
+        using difference_type = std::ptrdiff_t;
+
+        [[nodiscard]] iterator() = default;
+        [[nodiscard]] explicit iterator(token_stream& stream)
+            : stream_{ &stream },
+              current_{ stream.next() } {}
+
+        [[nodiscard]] auto operator*() const -> const stream_token& { return current_.value(); }
+        auto operator++() -> iterator& {
+            current_ = stream_->next();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        [[nodiscard]] friend bool operator==(const iterator& it, std::default_sentinel_t) {
+            return not it.current_.has_value();
+        }
+    };
+
+    [[nodiscard]] auto begin() -> iterator { return iterator{ *this }; }
+    [[nodiscard]] auto end() -> std::default_sentinel_t { return {}; }
+};
+
+} // namespace hycc
@@ -4,9 +4,15 @@
 #include <bits/ranges_base.h>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <ranges>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -15,141 +21,68 @@
 #include <variant>
 #include <vector>
 
+#include "hycc/char_class.hpp"
+#include "hycc/line_index.hpp"
+#include "hycc/mapped_file.hpp"
 #include "hycc/sstd.hpp"
+#include "hycc/symbol_table.hpp"
 #include "hycc/state_pattern_matcher.hpp"
 
 namespace hycc {
 
-enum class char_class {
-    whitespace,
-    id,
-    integer,
-    literal_scope_operator,
-    semantic_scope_operator,
-    operator_unit,
-    other
+/// Source code shared between source_code and tokens referring to it.
+///
+/// Code is either an owned string or a memory mapped file.
+struct source_text {
+    std::variant<std::u8string, mapped_file> storage;
+    line_index lines;
+
+    [[nodiscard]] constexpr source_text(std::u8string&& input)
+        : storage{ std::move(input) },
+          lines{ sv() } {}
+    [[nodiscard]] source_text(mapped_file&& file) : storage{ std::move(file) }, lines{ sv() } {}
+
+    [[nodiscard]] constexpr auto sv() const -> std::u8string_view {
+        return std::visit(sstd::overloaded{
+                              [](const std::u8string& code) { return std::u8string_view{ code }; },
+                              [](const mapped_file& file) { return file.sv(); } },
+                          storage);
+    }
 };
 
-[[nodiscard]] constexpr auto classify_char(const char8_t c) -> char_class {
-    using enum char_class;
-    switch (c) {
-        case (0x0009):
-        case (0x000B):
-        case (0x000C):
-        case (0x0020):
-        case (0x000A): return whitespace;
-        case (0x0041):
-        case (0x0042):
-        case (0x0043):
-        case (0x0044):
-        case (0x0045):
-        case (0x0046):
-        case (0x0047):
-        case (0x0048):
-        case (0x0049):
-        case (0x004A):
-        case (0x004B):
-        case (0x004C):
-        case (0x004D):
-        case (0x004E):
-        case (0x004F):
-        case (0x0050):
-        case (0x0051):
-        case (0x0052):
-        case (0x0054):
-        case (0x0055):
-        case (0x0056):
-        case (0x0057):
-        case (0x0058):
-        case (0x0059):
-        case (0x005A):
-        case (0x005F):
-        case (0x0061):
-        case (0x0062):
-        case (0x0063):
-        case (0x0064):
-        case (0x0065):
-        case (0x0066):
-        case (0x0067):
-        case (0x0068):
-        case (0x0069):
-        case (0x006A):
-        case (0x006B):
-        case (0x006C):
-        case (0x006D):
-        case (0x006E):
-        case (0x006F):
-        case (0x0070):
-        case (0x0071):
-        case (0x0072):
-        case (0x0073):
-        case (0x0074):
-        case (0x0075):
-        case (0x0076):
-        case (0x0077):
-        case (0x0078):
-        case (0x0079):
-        case (0x007A): return id;
-        case (0x0030):
-        case (0x0031):
-        case (0x0032):
-        case (0x0033):
-        case (0x0034):
-        case (0x0035):
-        case (0x0036):
-        case (0x0037):
-        case (0x0038):
-        case (0x0039): return integer;
-        case (0x0022):
-        case (0x0027):
-        case (0x0060): return literal_scope_operator;
-        case (0x0028):
-        case (0x0029):
-        case (0x002C):
-        case (0x002E):
-        case (0x003A):
-        case (0x003B):
-        case (0x005B):
-        case (0x005D):
-        case (0x007B):
-        case (0x007D): return semantic_scope_operator;
-        case (0x0021):
-        case (0x0023):
-        case (0x0024):
-        case (0x0025):
-        case (0x0026):
-        case (0x002A):
-        case (0x002B):
-        case (0x002D):
-        case (0x002F):
-        case (0x003C):
-        case (0x003D):
-        case (0x003E):
-        case (0x003F):
-        case (0x0040):
-        case (0x005C):
-        case (0x005E):
-        case (0x007C):
-        case (0x007E): return operator_unit;
-        default: return other;
-    }
-}
+/// Ownership of source_text, which can be shared between threads.
+using source_ownership = sstd::ownership<source_text, sstd::ownership_policy::atomic>;
 
 class source_code {
-    sstd::ownership<std::u8string> code_;
+    source_ownership text_;
+
+    [[nodiscard]] constexpr source_code(source_ownership text) : text_{ std::move(text) } {}
 
   public:
     [[nodiscard]] constexpr source_code(std::u8string&& input)
-        : code_{ sstd::make_shared_object<std::u8string>(std::move(input)) } {}
+        : text_{ sstd::make_shared_object<source_text, sstd::ownership_policy::atomic>(
+              std::move(input)) } {}
+
+    /// Source code of file at \p path, which is memory mapped instead of copied.
+    ///
+    /// Throws std::system_error if the file can not be mapped.
+    [[nodiscard]] static auto from_file(const std::filesystem::path& path) -> source_code {
+        return { sstd::make_shared_object<source_text, sstd::ownership_policy::atomic>(
+            mapped_file{ path }) };
+    }
 
     [[nodiscard]] constexpr auto sv(this auto&& me) -> std::u8string_view {
-        return me.code_.value();
+        return me.text_.value().sv();
     }
-    [[nodiscard]] constexpr auto get_ownership_of_code() { return code_; }
+    [[nodiscard]] constexpr auto position_of(const std::size_t offset) const -> source_position {
+        return text_.value().lines.position_of(offset);
+    }
+    [[nodiscard]] constexpr auto get_ownership_of_code() { return text_; }
 };
 
-enum class token_type {
+enum class token_type : std::uint8_t {
     whitespace,
+    comment,
     identifier,
     integer,
     literal,
@@ -161,6 +94,7 @@ enum class token_type {
 constexpr auto get_name(const token_type t) -> std::string {
     switch (t) {
         case token_type::whitespace: return { "whitespace" };
+        case token_type::comment: return { "comment" };
         case token_type::identifier: return { "identifier" };
         case token_type::integer: return { "integer" };
         case token_type::literal: return { "literal" };
@@ -171,59 +105,295 @@ constexpr auto get_name(const token_type t) -> std::string {
     }
 }
 
+/// Packed token, which refers to its source code by offset.
+///
+/// Text and position of the token are resolved through the token_buffer it belongs to.
 struct token {
     token_type type;
-    /// Token can not outlive the code it referes to.
-    [[maybe_unused]] sstd::ownership<std::u8string> source;
-    std::u8string_view sv_in_source;
-    std::size_t row;
-    std::size_t column;
+    /// Whitespace or comment is right before the token.
+    ///
+    /// Used to disambiguate unary and binary operators, see docs/sphinx/operators.rst.
+    bool preceded_by_whitespace;
+    /// Byte offset of the first character of the token in the source.
+    std::uint32_t offset;
+    std::uint32_t length;
+    /// Identifiers, operators and semantic scope operators have symbol, others have no_symbol.
+    symbol_id symbol;
+
+    [[nodiscard]] friend constexpr bool operator==(const token&, const token&) = default;
 };
 
-struct tokenize_state {
-    std::vector<token> tokens = std::vector<token>{};
-    using marker_type         = std::u8string_view::const_iterator;
+static_assert(sizeof(token) <= 16);
 
-    marker_type current_pos;
-    marker_type source_end;
+/// Where tokenize puts whitespace and comments, i.e. trivia.
+enum class trivia_mode : std::uint8_t {
+    /// Whitespace tokens are part of the tokens and comments are discarded.
+    in_stream,
+    /// Whitespace and comment tokens are stored in token_buffer::trivia(),
+    /// so the tokens contain only significant tokens.
+    side_table
+};
+
+/// How tokenize splits runs of operator characters to tokens.
+enum class operator_mode : std::uint8_t {
+    /// Every operator character is a token of its own,
+    /// so the parser matches multi character operators as sequences of tokens.
+    single_character,
+    /// Longest match of hycc::multi_character_operators is a single token.
+    ///
+    /// Whitespace around the operator is recorded as with single character operators,
+    /// so unary and binary operators are disambiguated the same way.
+    maximal_munch
+};
+
+/// Kind of a problem, which the tokenizer reports without stopping.
+enum class diagnostic_kind : std::uint8_t {
+    /// Error token of valid UTF-8, which is not in the basic character set.
+    unexpected_characters,
+    /// Error token containing code units, which are not valid UTF-8.
+    invalid_utf8,
+    /// Code unit in a literal, which does not begin a valid UTF-8 sequence.
+    invalid_utf8_in_literal
+};
+
+/// Problem found by the tokenizer in code units [offset, offset + length) of the source.
+struct tokenizer_diagnostic {
+    diagnostic_kind kind;
+    std::uint32_t offset;
+    std::uint32_t length;
+
+    [[nodiscard]] friend constexpr bool operator==(const tokenizer_diagnostic&,
+                                                   const tokenizer_diagnostic&) = default;
+};
+
+namespace detail {
+/// Access to the storage of token_buffer, so that it can be edited in place.
+struct token_buffer_access;
+} // namespace detail
+
+/// Tokens of one source code.
+///
+/// Holds the only ownership of the source code, so tokens do not have to.
+/// Tokens can not outlive the buffer they belong to.
+/// Buffers and source_code sharing the same source can be destroyed on different threads.
+///
+/// Tokens and trivia are allocated from a std::pmr::memory_resource,
+/// so that tokens of many sources can be allocated from a reusable arena,
+/// or with std::allocator, so that sources can be tokenized in constant evaluation.
+class token_buffer {
+    friend struct detail::token_buffer_access;
+
+    source_ownership source_;
+    sstd::resource_vector<token> tokens_;
+    sstd::resource_vector<token> trivia_;
+    trivia_mode mode_;
+    symbol_table symbols_;
+    operator_mode operators_;
+    sstd::resource_vector<tokenizer_diagnostic> diagnostics_;
+
+  public:
+    [[nodiscard]] constexpr token_buffer(
+        source_ownership source,
+        sstd::resource_vector<token>&& tokens,
+        sstd::resource_vector<token>&& trivia                     = {},
+        const trivia_mode mode                                    = trivia_mode::in_stream,
+        symbol_table&& symbols                                    = {},
+        const operator_mode operators                             = operator_mode::single_character,
+        sstd::resource_vector<tokenizer_diagnostic>&& diagnostics = {})
+        : source_{ std::move(source) },
+          tokens_{ std::move(tokens) },
+          trivia_{ std::move(trivia) },
+          mode_{ mode },
+          symbols_{ std::move(symbols) },
+          operators_{ operators },
+          diagnostics_{ std::move(diagnostics) } {}
+
+    [[nodiscard]] constexpr auto source_sv() const -> std::u8string_view {
+        return source_.value().sv();
+    }
+
+    /// Text of \p t in the source.
+    [[nodiscard]] constexpr auto sv(const token& t) const -> std::u8string_view {
+        return source_sv().substr(t.offset, t.length);
+    }
+
+    /// Row and column of \p t, resolved from the line index of the source.
+    [[nodiscard]] constexpr auto position(const token& t) const -> source_position {
+        return source_.value().lines.position_of(t.offset);
+    }
+
+    [[nodiscard]] constexpr auto tokens() const noexcept -> std::span<token const> {
+        return tokens_;
+    }
+
+    /// Whitespace and comment tokens in trivia_mode::side_table, otherwise empty.
+    [[nodiscard]] constexpr auto trivia() const noexcept -> std::span<token const> {
+        return trivia_;
+    }
+    [[nodiscard]] constexpr auto mode() const noexcept -> trivia_mode { return mode_; }
+    [[nodiscard]] constexpr auto operators() const noexcept -> operator_mode {
+        return operators_;
+    }
+
+    /// Memory resource of the tokens and trivia, or nullptr if they use std::allocator.
+    [[nodiscard]] constexpr auto resource() const noexcept -> std::pmr::memory_resource* {
+        return tokens_.get_allocator().resource();
+    }
 
-    sstd::ownership<std::u8string> source_ownership;
+    /// Symbols of the identifiers in the tokens.
+    [[nodiscard]] constexpr auto symbols() const noexcept -> const symbol_table& {
+        return symbols_;
+    }
+
+    /// Problems found by the tokenizer in the order of their offsets.
+    [[nodiscard]] constexpr auto diagnostics() const noexcept
+        -> std::span<tokenizer_diagnostic const> {
+        return diagnostics_;
+    }
 
-    std::size_t current_row = 0;
-    /// "Virtual newline" one first row is on column 0.
-    std::size_t current_column = 1;
+    /// Whitespace token covering all trivia between tokens at \p i - 1 and \p i.
+    ///
+    /// Index size() refers to the trivia at the end of the source.
+    /// Only meaningful in trivia_mode::side_table, where everything between tokens is trivia.
+    [[nodiscard]] constexpr auto whitespace_before(const std::size_t i) const
+        -> std::optional<token> {
+        if (i < tokens_.size() and not tokens_[i].preceded_by_whitespace) return {};
+
+        const auto source_size = static_cast<std::uint32_t>(source_sv().size());
+        const auto begin       = i == 0 ? 0u : tokens_[i - 1].offset + tokens_[i - 1].length;
+        const auto end         = i == tokens_.size() ? source_size : tokens_[i].offset;
+        if (begin == end) return {};
+        return token{ .type                   = token_type::whitespace,
+                      .preceded_by_whitespace = false,
+                      .offset                 = begin,
+                      .length                 = end - begin,
+                      .symbol                 = no_symbol };
+    }
+    [[nodiscard]] constexpr auto begin() const noexcept { return tokens_.begin(); }
+    [[nodiscard]] constexpr auto end() const noexcept { return tokens_.end(); }
+    [[nodiscard]] constexpr auto size() const noexcept { return tokens_.size(); }
+    [[nodiscard]] constexpr bool empty() const noexcept { return tokens_.empty(); }
+    [[nodiscard]] constexpr auto operator[](const std::size_t i) const -> const token& {
+        return tokens_[i];
+    }
+};
+
+/// Rough number of tokens in source code of \p source_size code units.
+///
+/// Typical source code has a token every few code units, so token storage reserved
+/// for this many grows only a few times, without reserving much more than the source size.
+[[nodiscard]] constexpr auto estimated_token_count(const std::size_t source_size) -> std::size_t {
+    return source_size / 8;
+}
+
+/// State of the tokenizer, which allocates tokens and trivia with \p Allocator.
+template<typename Allocator = std::allocator<token>>
+struct basic_tokenize_state {
+    using token_vector      = std::vector<token, Allocator>;
+    using diagnostic_vector = std::vector<
+        tokenizer_diagnostic,
+        typename std::allocator_traits<Allocator>::template rebind_alloc<tokenizer_diagnostic>>;
+
+    token_vector tokens;
+    token_vector trivia;
+    diagnostic_vector diagnostics;
+    symbol_table symbols = symbol_table{};
+    trivia_mode mode;
+    operator_mode operators;
+    /// Trivia has been found after the latest token.
+    bool preceded_by_whitespace = false;
+    /// Source ended inside a literal or a block comment.
+    bool unterminated = false;
+    using marker_type           = std::u8string_view::const_iterator;
+
+    marker_type source_begin;
+    marker_type current_pos;
+    marker_type source_end;
 
     struct {
-        std::size_t row       = 0;
-        std::size_t column    = 0;
         marker_type start_pos = nullptr;
     } cache;
 
-    constexpr void set_cache() {
-        cache.row       = current_row;
-        cache.column    = current_column;
-        cache.start_pos = current_pos;
+    constexpr void set_cache() { cache.start_pos = current_pos; }
+
+    [[nodiscard]] constexpr auto symbol_of_cache(const token_type type) -> symbol_id {
+        switch (type) {
+            case token_type::identifier: {
+                const auto id = std::u8string_view{ cache.start_pos, current_pos };
+                if (id.size() == 1) return symbol_id{ id.front() };
+                if (const auto keyword = keyword_id(id)) return keyword.value();
+                return symbols.intern_identifier(id, hash_symbol(id));
+            }
+            case token_type::semantic_scope_operator:
+            case token_type::operator_token:
+                if (current_pos - cache.start_pos == 1) return symbol_id{ *cache.start_pos };
+                return multi_character_operator_id({ cache.start_pos, current_pos }).value();
+            default: return no_symbol;
+        }
     }
 
-    constexpr void tokenize_cache(const token_type type) {
-        tokens.push_back(
-            { type, source_ownership, { cache.start_pos, current_pos }, cache.row, cache.column });
+    /// Reports \p kind for code units [\p begin, \p end).
+    constexpr void diagnose(const diagnostic_kind kind,
+                            const marker_type begin,
+                            const marker_type end) {
+        diagnostics.push_back({ .kind   = kind,
+                                .offset = static_cast<std::uint32_t>(begin - source_begin),
+                                .length = static_cast<std::uint32_t>(end - begin) });
     }
 
-    [[nodiscard]] constexpr tokenize_state(source_code& source)
-        : current_pos{ source.sv().begin() },
-          source_end{ source.sv().end() },
-          source_ownership{ source.get_ownership_of_code() } {}
+    constexpr void tokenize_cache(const token_type type) {
+        const auto t = token{
+            .type                   = type,
+            .preceded_by_whitespace = preceded_by_whitespace,
+            .offset                 = static_cast<std::uint32_t>(cache.start_pos - source_begin),
+            .length                 = static_cast<std::uint32_t>(current_pos - cache.start_pos),
+            .symbol                 = symbol_of_cache(type)
+        };
+
+        const auto is_trivia = type == token_type::whitespace or type == token_type::comment;
+        if (not is_trivia) {
+            tokens.push_back(t);
+            preceded_by_whitespace = false;
+            return;
+        }
 
-    // Advances until current_pos is at \n or at last character of source.
-    constexpr void skip_line() {
-        const auto new_line_pos     = std::ranges::find(current_pos, source_end, u8'\n');
-        auto lenght_of_rest_of_line = static_cast<std::size_t>(new_line_pos - current_pos);
+        if (mode == trivia_mode::side_table) {
+            trivia.push_back(t);
+        } else if (type == token_type::whitespace) {
+            tokens.push_back(t);
+        }
+        preceded_by_whitespace = true;
+    }
 
-        // At last line, so advance only to last character.
-        if (new_line_pos == source_end) lenght_of_rest_of_line -= 1;
+    [[nodiscard]] constexpr basic_tokenize_state(const std::u8string_view source,
+                                                 const trivia_mode trivia_handling,
+                                                 const operator_mode operator_handling =
+                                                     operator_mode::single_character,
+                                                 const Allocator& allocator = Allocator{})
+        : tokens(allocator),
+          trivia(allocator),
+          diagnostics(allocator),
+          mode{ trivia_handling },
+          operators{ operator_handling },
+          source_begin{ source.begin() },
+          current_pos{ source.begin() },
+          source_end{ source.end() } {}
+
+    /// One past the end of the run of \p run starting at current_pos.
+    [[nodiscard]] constexpr auto find_run_end(const char_run run) const -> marker_type {
+        const auto length = run_length(run, { current_pos, source_end });
+        return current_pos + static_cast<std::ptrdiff_t>(length);
+    }
+
+    /// One past the \n ending the line at current_pos, or the end of source on the last line.
+    [[nodiscard]] constexpr auto find_line_end() const -> marker_type {
+        const auto newline = std::ranges::find(current_pos, source_end, u8'\n');
+        return newline == source_end ? newline : newline + 1;
+    }
 
-        for ([[maybe_unused]] auto _ : std::views::iota(0uz, lenght_of_rest_of_line)) advance();
+    /// Number of code units from current_pos to \p pos.
+    [[nodiscard]] constexpr auto distance_to(const marker_type pos) const -> std::size_t {
+        return static_cast<std::size_t>(pos - current_pos);
     }
 
     // Tests if \p str begins at current_pos.
@@ -244,217 +414,376 @@ struct tokenize_state {
         return std::ranges::equal(str, std::u8string_view{ current_pos, str.size() });
     }
 
-    constexpr void advance() {
-        ++current_pos;
+    /// Length of the operator at current_pos, which is the longest match of
+    /// hycc::multi_character_operators in operator_mode::maximal_munch.
+    [[nodiscard]] constexpr auto operator_length() const -> std::size_t {
+        if (operators == operator_mode::single_character) return 1;
+        // Characters of an operator are of the same class.
+        const auto at_end = current_pos + 1 == source_end;
+        if (at_end or classify_char(current_pos[1]) != classify_char(*current_pos)) return 1;
 
-        if (*current_pos == u8'\n') {
-            ++current_row;
-            current_column = 0;
-        } else
-            ++current_column;
+        for (const auto op : multi_character_operators) {
+            if (match_str(op)) return op.size();
+        }
+        return 1;
     }
+
+    constexpr void advance() { ++current_pos; }
+    constexpr void advance_by(const std::size_t n) {
+        current_pos += static_cast<std::ptrdiff_t>(n);
+    }
+
+    /// Code unit at current_pos, used to find the patterns which can begin at it.
+    [[nodiscard]] constexpr auto peek() const -> char8_t { return *current_pos; }
 };
 
-[[nodiscard]] constexpr auto tokenize(source_code& source) -> std::vector<token> {
+using tokenize_state = basic_tokenize_state<>;
+
+/// Tokenizes \p source, which offsets of the tokens are relative to.
+///
+/// Tokens and trivia are allocated with \p allocator.
+template<typename Allocator = std::allocator<token>>
+[[nodiscard]] constexpr auto run_tokenizer(const std::u8string_view source,
+                                           const trivia_mode mode,
+                                           const operator_mode operators =
+                                               operator_mode::single_character,
+                                           const Allocator& allocator = Allocator{})
+    -> basic_tokenize_state<Allocator> {
+    if (source.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{ "Source code is too large to be tokenized!" };
+    }
+
+    using state_type = basic_tokenize_state<Allocator>;
+
     // Construct a state pattern matcher:
     using namespace state_pattern_matcher;
 
     struct line_comment_t {
-        auto operator()(predicate_tag, const tokenize_state& state) {
+        static constexpr bool can_start_with(const unsigned char c) { return c == u8'/'; }
+
+        constexpr auto operator()(predicate_tag, const state_type& state) {
             return state.match_str(u8"//");
         }
-        auto operator()(begin_tag, tokenize_state& state) {
-            // Skip until at \n or at the last character of source.
-            state.skip_line();
+        constexpr auto operator()(begin_tag, state_type& state) { state.set_cache(); }
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        // Consume until one past \n or the end of source.
+        constexpr auto operator()(consume_tag, const state_type& state) -> std::size_t {
+            return state.distance_to(state.find_line_end());
         }
-        auto operator()(continuation_tag, tokenize_state& state) {
-            // Skip until at \n or at the last character of source.
-            state.skip_line();
 
-            //    const auto at_last_char_of_last_line = not state.match_str<2>(u8"");
-            //    if (last_line) state.advance();
+        constexpr auto operator()(end_tag, state_type& state) {
+            state.tokenize_cache(token_type::comment);
         }
-
-        auto operator()(end_tag, tokenize_state&) {}
     };
 
     struct block_comment_t {
+        static constexpr bool can_start_with(const unsigned char c) { return c == u8'/'; }
+
         bool in_block_comment = false;
-        bool delimiter_found  = false;
-        bool second_skip      = false;
-
-        auto operator()(predicate_tag, const tokenize_state& state) {
-            if (delimiter_found) {
-                // at / of delimiter */.
-                if (second_skip) return false;
-                // at * of delimiter */, so have to skip one more.
-                second_skip = true;
-                return true;
-            }
+        bool terminated       = false;
 
-            // If inside block comment predicate is always true.
-            if (in_block_comment) {
-                const auto at_end_delimiter = state.match_str(u8"*/");
-                // Store if at delimiter, so next predicate can return false.
-                delimiter_found = at_end_delimiter;
-                return true;
-            }
+        constexpr auto operator()(predicate_tag, const state_type& state) {
+            // Whole comment is consumed at once, so it never continues.
+            if (in_block_comment) return false;
 
             // Looking for block comment.
             in_block_comment = state.match_str(u8"/*");
             return in_block_comment;
         }
-        auto operator()(begin_tag, tokenize_state&) {}
-        auto operator()(continuation_tag, tokenize_state&) {}
-        auto operator()(end_tag, tokenize_state&) {
+        constexpr auto operator()(begin_tag, state_type& state) { state.set_cache(); }
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        // Consume until one past the end delimiter */ or the end of source.
+        constexpr auto operator()(consume_tag, const state_type& state) -> std::size_t {
+            const auto body      = std::u8string_view{ state.current_pos + 2, state.source_end };
+            const auto delimiter = body.find(u8"*/");
+            terminated           = delimiter != std::u8string_view::npos;
+            if (not terminated) return state.distance_to(state.source_end);
+            return 2 + delimiter + 2;
+        }
+        constexpr auto operator()(end_tag, state_type& state) {
+            state.tokenize_cache(token_type::comment);
+            if (not terminated) state.unterminated = true;
             in_block_comment = false;
-            delimiter_found  = false;
-            second_skip      = false;
+            terminated       = false;
+        }
+    };
+
+    struct whitespace_t {
+        static constexpr bool can_start_with(const unsigned char c) {
+            return classify_char(c) == char_class::whitespace;
+        }
+
+        std::optional<typename state_type::marker_type> run_end{};
+
+        constexpr auto operator()(predicate_tag, const state_type& state) {
+            if (run_end) return state.current_pos != run_end.value();
+            return classify_char(*state.current_pos) == char_class::whitespace;
+        }
+        constexpr auto operator()(begin_tag, state_type& state) {
+            run_end = state.find_run_end(char_run::whitespace);
+            state.set_cache();
+        }
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        constexpr auto operator()(consume_tag, const state_type& state) -> std::size_t {
+            return state.distance_to(run_end.value());
+        }
+        constexpr auto operator()(end_tag, state_type& state) {
+            run_end.reset();
+            state.tokenize_cache(token_type::whitespace);
         }
     };
 
-    auto whitespace =
-        sstd::overloaded{ [](predicate_tag, const auto& state) {
-                             return classify_char(*state.current_pos) == char_class::whitespace;
-                         },
-                          [](begin_tag, auto& state) { state.set_cache(); },
-                          [](continuation_tag, auto) {},
-                          [](end_tag, auto& state) {
-                              state.tokenize_cache(token_type::whitespace);
-                          } };
-
-    auto integer =
-        sstd::overloaded{ [](predicate_tag, const auto& state) {
-                             return classify_char(*state.current_pos) == char_class::integer;
-                         },
-                          [](begin_tag, auto& state) { state.set_cache(); },
-                          [](continuation_tag, auto) {},
-                          [](end_tag, auto& state) { state.tokenize_cache(token_type::integer); } };
+    struct integer_t {
+        static constexpr bool can_start_with(const unsigned char c) {
+            return classify_char(c) == char_class::integer;
+        }
+
+        std::optional<typename state_type::marker_type> run_end{};
+
+        constexpr auto operator()(predicate_tag, const state_type& state) {
+            if (run_end) return state.current_pos != run_end.value();
+            return classify_char(*state.current_pos) == char_class::integer;
+        }
+        constexpr auto operator()(begin_tag, state_type& state) {
+            run_end = state.find_run_end(char_run::integer);
+            state.set_cache();
+        }
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        constexpr auto operator()(consume_tag, const state_type& state) -> std::size_t {
+            return state.distance_to(run_end.value());
+        }
+        constexpr auto operator()(end_tag, state_type& state) {
+            run_end.reset();
+            state.tokenize_cache(token_type::integer);
+        }
+    };
 
     struct literal_t {
-        std::optional<char8_t> delimiter{};
-        bool delimiter_found = false;
-
-        auto operator()(predicate_tag, const tokenize_state& state) {
-            // Stop if delimiter is found on previous round.
-            if (delimiter_found) return false;
-
-            // If inside literal or at delimiter always continue.
-            if (delimiter) {
-                const auto at_end_delimiter = state.match_str(std::u8string{ delimiter.value() });
-                // Store if at delimiter, so next predicate can return false.
-                delimiter_found = at_end_delimiter;
-                return true;
-            }
+        static constexpr bool can_start_with(const unsigned char c) {
+            return classify_char(c) == char_class::literal_scope_operator;
+        }
+
+        bool in_literal = false;
+        bool terminated = false;
+
+        constexpr auto operator()(predicate_tag, const state_type& state) {
+            // Whole literal is consumed at once, so it never continues.
+            if (in_literal) return false;
 
             // Looking for new literal.
             const auto c_class = classify_char(*state.current_pos);
-            return c_class == char_class::literal_scope_operator;
+            in_literal         = c_class == char_class::literal_scope_operator;
+            return in_literal;
         }
-        auto operator()(begin_tag, tokenize_state& state) {
-            // Store which delimiter we are looking for.
-            delimiter = *state.current_pos;
-            state.set_cache();
+        constexpr auto operator()(begin_tag, state_type& state) { state.set_cache(); }
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        // Consume until one past the closing delimiter or the end of source.
+        constexpr auto operator()(consume_tag, const state_type& state) -> std::size_t {
+            const auto literal   = std::u8string_view{ state.current_pos, state.source_end };
+            const auto delimiter = literal.front();
+            const auto is_raw =
+                literal.size() >= 3 and literal[1] == delimiter and literal[2] == delimiter;
+            return is_raw ? raw_length(literal) : escaped_length(literal);
+        }
+
+        /// Length of literal, which begins with a single delimiter and can contain escapes.
+        constexpr auto escaped_length(const std::u8string_view literal) -> std::size_t {
+            const auto delimiter = literal.front();
+            for (auto i = 1uz; i < literal.size();) {
+                i += find_either(literal.substr(i), delimiter, u8'\\');
+                if (i == literal.size()) break;
+                if (literal[i] == delimiter) {
+                    terminated = true;
+                    return i + 1;
+                }
+                // Escape next char after backslash if it exists.
+                i += 2;
+            }
+            return literal.size();
         }
-        auto operator()(continuation_tag, tokenize_state& state) {
-            // Escape next char after backslash if it exits.
-            if (state.match_str<1>(std::u8string{ '\\' })) state.advance();
+
+        /// Length of raw literal, which begins with three delimiters
+        /// and ends at the next three delimiters, without escapes in between.
+        constexpr auto raw_length(const std::u8string_view literal) -> std::size_t {
+            const auto delimiter = literal.front();
+            for (auto i = 3uz; i < literal.size(); ++i) {
+                i += find_either(literal.substr(i), delimiter, delimiter);
+                if (i + 3 > literal.size()) break;
+                if (literal[i + 1] == delimiter and literal[i + 2] == delimiter) {
+                    terminated = true;
+                    return i + 3;
+                }
+            }
+            return literal.size();
         }
 
-        auto operator()(end_tag, tokenize_state& state) {
+        constexpr auto operator()(end_tag, state_type& state) {
+            const auto literal = std::u8string_view{ state.cache.start_pos, state.current_pos };
+            const auto invalid = find_invalid_utf8(literal);
+            if (invalid != literal.size()) {
+                const auto pos = state.cache.start_pos + static_cast<std::ptrdiff_t>(invalid);
+                state.diagnose(diagnostic_kind::invalid_utf8_in_literal, pos, pos + 1);
+            }
+
             state.tokenize_cache(token_type::literal);
-            delimiter.reset();
-            delimiter_found = false;
+            if (not terminated) state.unterminated = true;
+            in_literal = false;
+            terminated = false;
         }
     };
 
     struct semantic_scope_operator_t {
+        static constexpr bool can_start_with(const unsigned char c) {
+            return classify_char(c) == char_class::semantic_scope_operator;
+        }
+
         bool next_perdicate_is_false = false;
-        auto operator()(predicate_tag, const tokenize_state& state) -> bool {
+        std::size_t length           = 1;
+        constexpr auto operator()(predicate_tag, const state_type& state) -> bool {
             if (next_perdicate_is_false) return false;
             const auto c_class = classify_char(*state.current_pos);
             return c_class == char_class::semantic_scope_operator;
         }
-        auto operator()(begin_tag, tokenize_state& state) {
+        constexpr auto operator()(begin_tag, state_type& state) {
             next_perdicate_is_false = true;
+            length                  = state.operator_length();
             state.set_cache();
         }
-        auto operator()(continuation_tag, tokenize_state&) {}
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        constexpr auto operator()(consume_tag, const state_type&) -> std::size_t { return length; }
 
-        auto operator()(end_tag, tokenize_state& state) {
+        constexpr auto operator()(end_tag, state_type& state) {
             next_perdicate_is_false = false;
             state.tokenize_cache(token_type::semantic_scope_operator);
         }
     };
 
     struct operator_token_t {
+        static constexpr bool can_start_with(const unsigned char c) {
+            return classify_char(c) == char_class::operator_unit;
+        }
+
         bool next_perdicate_is_false = false;
-        auto operator()(predicate_tag, const tokenize_state& state) -> bool {
+        std::size_t length           = 1;
+        constexpr auto operator()(predicate_tag, const state_type& state) -> bool {
             if (next_perdicate_is_false) return false;
             return classify_char(*state.current_pos) == char_class::operator_unit;
         }
-        auto operator()(begin_tag, tokenize_state& state) {
+        constexpr auto operator()(begin_tag, state_type& state) {
             next_perdicate_is_false = true;
+            length                  = state.operator_length();
             state.set_cache();
         }
-        auto operator()(continuation_tag, tokenize_state&) {}
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        constexpr auto operator()(consume_tag, const state_type&) -> std::size_t { return length; }
 
-        auto operator()(end_tag, tokenize_state& state) {
+        constexpr auto operator()(end_tag, state_type& state) {
             next_perdicate_is_false = false;
             state.tokenize_cache(token_type::operator_token);
         }
     };
 
     struct identifier_t {
-        bool next_char_is_first = true;
-        auto operator()(predicate_tag, const tokenize_state& state) {
-            const auto char_class = classify_char(*state.current_pos);
-            if (next_char_is_first) return char_class == char_class::id;
-            return char_class == char_class::id or char_class == char_class::integer;
-        }
-        auto operator()(begin_tag, tokenize_state& state) {
-            next_char_is_first = false;
+        static constexpr bool can_start_with(const unsigned char c) {
+            return classify_char(c) == char_class::id;
+        }
+
+        std::optional<typename state_type::marker_type> run_end{};
+
+        constexpr auto operator()(predicate_tag, const state_type& state) {
+            if (run_end) return state.current_pos != run_end.value();
+            return classify_char(*state.current_pos) == char_class::id;
+        }
+        constexpr auto operator()(begin_tag, state_type& state) {
+            // First character is id, so it is also part of id continuation run.
+            run_end = state.find_run_end(char_run::id_continuation);
             state.set_cache();
         }
-        auto operator()(continuation_tag, tokenize_state) {}
-        auto operator()(end_tag, tokenize_state& state) {
-            next_char_is_first = true;
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        constexpr auto operator()(consume_tag, const state_type& state) -> std::size_t {
+            return state.distance_to(run_end.value());
+        }
+        constexpr auto operator()(end_tag, state_type& state) {
+            run_end.reset();
             state.tokenize_cache(token_type::identifier);
         }
     };
 
+    /// Run of unrecognized code units is a single error token, which is also diagnosed.
     struct error_token_t {
-        bool next_perdicate_is_false = false;
-        auto operator()(predicate_tag, const tokenize_state& state) -> bool {
-            if (next_perdicate_is_false) return false;
-            const auto c_class = classify_char(*state.current_pos);
-            return c_class == char_class::other;
+        static constexpr bool can_start_with(const unsigned char c) {
+            return classify_char(c) == char_class::other;
         }
-        auto operator()(begin_tag, tokenize_state& state) {
-            next_perdicate_is_false = true;
+
+        std::optional<typename state_type::marker_type> run_end{};
+
+        constexpr auto operator()(predicate_tag, const state_type& state) {
+            if (run_end) return state.current_pos != run_end.value();
+            return classify_char(*state.current_pos) == char_class::other;
+        }
+        constexpr auto operator()(begin_tag, state_type& state) {
+            run_end = state.find_run_end(char_run::other);
             state.set_cache();
         }
-        auto operator()(continuation_tag, tokenize_state&) {}
+        constexpr auto operator()(continuation_tag, state_type&) {}
+        constexpr auto operator()(consume_tag, const state_type& state) -> std::size_t {
+            return state.distance_to(run_end.value());
+        }
 
-        auto operator()(end_tag, tokenize_state& state) {
-            next_perdicate_is_false = false;
+        constexpr auto operator()(end_tag, state_type& state) {
+            run_end.reset();
+            const auto run = std::u8string_view{ state.cache.start_pos, state.current_pos };
+            auto kind      = diagnostic_kind::unexpected_characters;
+            if (find_invalid_utf8(run) != run.size()) kind = diagnostic_kind::invalid_utf8;
+            state.diagnose(kind, state.cache.start_pos, state.current_pos);
             state.tokenize_cache(token_type::error);
         }
     };
 
-    auto matcher = create_matcher_for<tokenize_state>(block_comment_t{},
-                                                      line_comment_t{},
-                                                      whitespace,
-                                                      integer,
-                                                      literal_t{},
-                                                      semantic_scope_operator_t{},
-                                                      operator_token_t{},
-                                                      identifier_t{},
-                                                      error_token_t{});
+    auto matcher = create_matcher_for<state_type>(block_comment_t{},
+                                                  line_comment_t{},
+                                                  whitespace_t{},
+                                                  integer_t{},
+                                                  literal_t{},
+                                                  semantic_scope_operator_t{},
+                                                  operator_token_t{},
+                                                  identifier_t{},
+                                                  error_token_t{});
+
+    auto initial_state = state_type{ source, mode, operators, allocator };
+    initial_state.tokens.reserve(estimated_token_count(source.size()));
+    if (mode == trivia_mode::side_table)
+        initial_state.trivia.reserve(estimated_token_count(source.size()));
+
+    return matcher(std::move(initial_state), [](auto& state) {
+        return state.current_pos == state.source_end;
+    });
+}
 
-    const auto final_state =
-        matcher({ source }, [](auto& state) { return state.current_pos == state.source_end; });
+/// Tokenizes \p source with trivia handled as in \p mode and operators as in \p operators.
+///
+/// Tokens and trivia are allocated from \p resource, or with std::allocator if it is nullptr.
+[[nodiscard]] constexpr auto tokenize(source_code& source,
+                                      const trivia_mode mode,
+                                      const operator_mode operators,
+                                      std::pmr::memory_resource* const resource) -> token_buffer {
+    auto final_state =
+        run_tokenizer(source.sv(), mode, operators, sstd::resource_allocator<token>{ resource });
+    return { source.get_ownership_of_code(),
+             std::move(final_state.tokens),
+             std::move(final_state.trivia),
+             mode,
+             std::move(final_state.symbols),
+             operators,
+             std::move(final_state.diagnostics) };
+}
 
-    return final_state.tokens;
+/// Tokenizes \p source with tokens and trivia allocated with std::allocator,
+/// so that it can be used in constant evaluation.
+[[nodiscard]] constexpr auto
+    tokenize(source_code& source,
+             const trivia_mode mode        = trivia_mode::in_stream,
+             const operator_mode operators = operator_mode::single_character) -> token_buffer {
+    return tokenize(source, mode, operators, nullptr);
 }
 } // namespace hycc
@@ -0,0 +1,74 @@
+#pragma once
+
+/// @file Counts heap allocations by replacing global operator new and delete.
+///
+/// Replacement functions have to be defined only once in a program,
+/// so include this header to exactly one translation unit of a benchmark or a test.
+/// Every allocation of that program is then counted, not only those of the measured code.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace hycc::support {
+
+struct allocation_counts {
+    std::size_t allocations;
+    std::size_t bytes;
+};
+
+namespace detail {
+
+inline auto allocations = std::atomic<std::size_t>{ 0 };
+inline auto bytes       = std::atomic<std::size_t>{ 0 };
+
+[[nodiscard]] inline auto counted_allocate(const std::size_t size, const std::size_t alignment)
+    -> void* {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+
+    // Allocation of zero bytes has to return unique pointer.
+    const auto n = size == 0 ? 1uz : size;
+    void* ptr    = nullptr;
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        ptr = std::malloc(n);
+    } else {
+        // Size of aligned_alloc has to be multiple of the alignment.
+        ptr = std::aligned_alloc(alignment, (n + alignment - 1) / alignment * alignment);
+    }
+    if (ptr == nullptr) throw std::bad_alloc{};
+    return ptr;
+}
+
+} // namespace detail
+
+/// Allocations made by the whole program so far.
+[[nodiscard]] inline auto allocations_so_far() -> allocation_counts {
+    return { detail::allocations.load(std::memory_order_relaxed),
+             detail::bytes.load(std::memory_order_relaxed) };
+}
+
+} // namespace hycc::support
+
+void* operator new(const std::size_t size) {
+    return hycc::support::detail::counted_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](const std::size_t size) {
+    return hycc::support::detail::counted_allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    return hycc::support::detail::counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](const std::size_t size, const std::align_val_t alignment) {
+    return hycc::support::detail::counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* const ptr) noexcept { std::free(ptr); }
+void operator delete[](void* const ptr) noexcept { std::free(ptr); }
+void operator delete(void* const ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* const ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* const ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* const ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* const ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* const ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
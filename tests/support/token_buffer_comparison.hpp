@@ -0,0 +1,100 @@
+#pragma once
+
+/// @file Checks that tokens produced in different ways are identical to tokens of tokenize.
+
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <array>
+#include <cstddef>
+#include <format>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "hycc/token_stream.hpp"
+#include "hycc/tokenizer.hpp"
+
+namespace hycc::support {
+
+inline constexpr auto trivia_modes = std::array{ trivia_mode::in_stream, trivia_mode::side_table };
+
+/// How symbols of tokens are compared.
+enum class symbol_comparison {
+    /// Symbol ids have to be equal, as when both buffers intern to a symbol table of their own.
+    by_id,
+    /// Symbols have to have the same names, as when \p got extends an earlier symbol table.
+    by_name
+};
+
+/// Text of \p str, which can be printed as part of a failure message.
+[[nodiscard]] inline auto printable(const std::u8string_view str) -> std::string {
+    return std::string{ str.begin(), str.end() };
+}
+
+/// Checks that \p got has the same tokens, trivia and diagnostics as \p expected.
+///
+/// \p at is printed with every failure.
+inline void expect_same_tokens(const token_buffer& got,
+                               const token_buffer& expected,
+                               const std::string_view at,
+                               const symbol_comparison symbols = symbol_comparison::by_id) {
+    using namespace boost::ut;
+
+    auto without_symbol = [](const token& t) {
+        return std::tuple{ t.type, t.preceded_by_whitespace, t.offset, t.length };
+    };
+    expect(std::ranges::equal(got.tokens(), expected.tokens(), {}, without_symbol, without_symbol))
+        << at;
+    expect(std::ranges::equal(got.trivia(), expected.trivia())) << at;
+    expect(std::ranges::equal(got.diagnostics(), expected.diagnostics())) << at;
+    expect(got.operators() == expected.operators()) << at;
+    if (got.size() != expected.size()) return;
+
+    for (const auto i : std::views::iota(0uz, got.size())) {
+        const auto& a = got[i];
+        const auto& b = expected[i];
+        if (symbols == symbol_comparison::by_id or a.symbol == no_symbol
+            or b.symbol == no_symbol) {
+            expect(a.symbol == b.symbol) << std::format("{}, token {}", at, i);
+        } else {
+            expect(got.symbols().name(a.symbol) == expected.symbols().name(b.symbol))
+                << std::format("{}, token {}", at, i);
+        }
+    }
+}
+
+/// Checks that the rest of \p got has the same tokens and diagnostics as \p expected.
+///
+/// \p at is printed with every failure.
+inline void expect_same_tokens(token_stream& got,
+                               const token_buffer& expected,
+                               const std::string_view at) {
+    using namespace boost::ut;
+
+    auto i = 0uz;
+    for (const auto& t : got) {
+        if (i >= expected.size()) {
+            ++i;
+            continue;
+        }
+        const auto& e       = expected[i++];
+        const auto token_at = std::format("{}, token {}", at, i - 1);
+        expect(t.type == e.type) << token_at;
+        expect(t.preceded_by_whitespace == e.preceded_by_whitespace) << token_at;
+        expect(t.offset == e.offset) << token_at;
+        expect(t.sv == expected.sv(e)) << token_at;
+        expect(t.position == expected.position(e)) << token_at;
+        expect(t.symbol == e.symbol) << token_at;
+    }
+    expect(i == expected.size())
+        << std::format("{}: expected {} tokens, got {}", at, expected.size(), i);
+
+    expect(got.diagnostics().size() == expected.diagnostics().size()) << at;
+    for (const auto [g, e] : std::views::zip(got.diagnostics(), expected.diagnostics())) {
+        expect(g.kind == e.kind and g.offset == e.offset and g.length == e.length)
+            << std::format("{}, diagnostic at {}", at, e.offset);
+    }
+}
+
+} // namespace hycc::support
@@ -0,0 +1,143 @@
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <format>
+#include <ranges>
+#include <string>
+#include <string_view>
+
+#include "hycc/char_class.hpp"
+
+/// Reference implementation of run_length.
+constexpr auto naive_run_length(const hycc::char_run run, const std::u8string_view str) {
+    const auto it = std::ranges::find_if_not(str, [&](const char8_t c) {
+        return hycc::is_part_of_run(run, c);
+    });
+    return static_cast<std::size_t>(it - str.begin());
+}
+
+int main() {
+    using namespace boost::ut;
+    using namespace hycc;
+
+    "char_class_table agrees with documented ranges"_test = [] {
+        for (const auto i : std::views::iota(0uz, 256uz)) {
+            const auto c        = static_cast<char8_t>(i);
+            const auto is_upper = c >= u8'A' and c <= u8'Z';
+            const auto is_lower = c >= u8'a' and c <= u8'z';
+            const auto is_id    = is_upper or is_lower or c == u8'_';
+            expect(is_id == (classify_char(c) == char_class::id))
+                << std::format("{:X} is classified wrong!", c);
+        }
+    };
+
+    "code units outside of basic character set are other"_test = [] {
+        for (const auto i : std::views::iota(0x80uz, 256uz)) {
+            const auto c = static_cast<char8_t>(i);
+            expect(classify_char(c) == char_class::other)
+                << std::format("{:X} is classified wrong!", c);
+        }
+    };
+
+    "run_length can be evaluated at compile time"_test = [] {
+        static_assert(run_length(char_run::whitespace, u8" \t\n\v\fa") == 5);
+        static_assert(run_length(char_run::integer, u8"0123456789a") == 10);
+        static_assert(run_length(char_run::id_continuation, u8"aZ_09 ") == 5);
+        static_assert(run_length(char_run::id_continuation, u8"") == 0);
+    };
+
+    "run_length finds end of runs"_test = [] {
+        expect(run_length(char_run::whitespace, u8"  \n\tfoo") == 4);
+        expect(run_length(char_run::whitespace, u8"foo") == 0);
+        expect(run_length(char_run::integer, u8"123abc") == 3);
+        expect(run_length(char_run::id_continuation, u8"abc123+") == 6);
+        expect(run_length(char_run::id_continuation, u8"SOME_ID") == 7);
+        expect(run_length(char_run::id_continuation, u8"@[`{") == 0);
+    };
+
+    "run_length agrees with scalar classification for every run end position"_test = [] {
+        constexpr auto runs    = std::array{ char_run::whitespace,
+                                             char_run::integer,
+                                             char_run::id_continuation,
+                                             char_run::other };
+        constexpr auto fillers = std::array<std::u8string_view, 4>{
+            u8" \t\n", u8"0123456789", u8"azAZ_09", u8"\x01\r\x7f\x80\xff"
+        };
+
+        for (const auto [run, filler] : std::views::zip(runs, fillers)) {
+            // Long enough to span multiple vector registers and a scalar tail.
+            for (const auto length : std::views::iota(0uz, 100uz)) {
+                for (const auto terminator : std::views::iota(0uz, 256uz)) {
+                    auto str = std::u8string{};
+                    for (const auto i : std::views::iota(0uz, length)) {
+                        str.push_back(filler[i % filler.size()]);
+                    }
+                    str.push_back(static_cast<char8_t>(terminator));
+                    str.append(u8"    ");
+
+                    const auto got      = run_length(run, str);
+                    const auto expected = naive_run_length(run, str);
+                    expect(got == expected)
+                        << std::format("run of length {} followed by {:X}: expected {}, got {}",
+                                       length,
+                                       terminator,
+                                       expected,
+                                       got);
+                }
+            }
+        }
+    };
+
+    "find_either can be evaluated at compile time"_test = [] {
+        static_assert(find_either(u8"abc\"d\\", u8'"', u8'\\') == 3);
+        static_assert(find_either(u8"abc", u8'"', u8'\\') == 3);
+        static_assert(find_either(u8"", u8'"', u8'\\') == 0);
+    };
+
+    "find_either agrees with scalar search for every position"_test = [] {
+        // Long enough to cover the vectorized loop and the scalar tail.
+        for (const auto size : { 0uz, 1uz, 15uz, 16uz, 17uz, 31uz, 32uz, 33uz, 100uz }) {
+            for (auto pos = 0uz; pos <= size; ++pos) {
+                for (const auto c : { u8'"', u8'\\' }) {
+                    auto str = std::u8string(size, u8'a');
+                    if (pos < size) str[pos] = c;
+                    expect(find_either(str, u8'"', u8'\\') == pos)
+                        << std::format("size {}, position {}", size, pos);
+                }
+            }
+        }
+    };
+
+    "utf8_sequence_length accepts only valid sequences"_test = [] {
+        static_assert(utf8_sequence_length(u8"a") == 1);
+        static_assert(utf8_sequence_length(u8"é") == 2);
+        static_assert(utf8_sequence_length(u8"€") == 3);
+        static_assert(utf8_sequence_length(u8"\U0001F600") == 4);
+        static_assert(utf8_sequence_length(u8"") == 0);
+
+        // Overlong encodings, surrogates, too large code points and truncated sequences.
+        const auto invalid = std::array<std::u8string_view, 8>{
+            u8"\xc0\x80", u8"\xc1\xbf",     u8"\xe0\x9f\xbf", u8"\xed\xa0\x80",
+            u8"\xf0\x8f\xbf\xbf", u8"\xf4\x90\x80\x80", u8"\xe2\x82", u8"\x80"
+        };
+        for (const auto str : invalid) expect(utf8_sequence_length(str) == 0);
+    };
+
+    "find_invalid_utf8 finds the first invalid code unit"_test = [] {
+        static_assert(find_invalid_utf8(u8"abc é€") == 9);
+        static_assert(find_invalid_utf8(u8"ab\xff") == 2);
+
+        // Invalid code unit at every position of ASCII long enough for the vectorized loop.
+        for (const auto size : { 1uz, 16uz, 17uz, 32uz, 33uz, 100uz }) {
+            for (auto pos = 0uz; pos < size; ++pos) {
+                auto str = std::u8string(size, u8'a');
+                str[pos] = char8_t{ 0xff };
+                expect(find_invalid_utf8(str) == pos)
+                    << std::format("size {}, position {}", size, pos);
+            }
+            expect(find_invalid_utf8(std::u8string(size, u8'a')) == size);
+        }
+    };
+}
@@ -46,6 +46,23 @@ int main() {
         expect(nothrow([&] { id.push(parser); }));
     };
 
+    "identifier_node can match :: tokenized with maximal munch"_test = [] {
+        auto source       = source_code(u8"a::b::c;");
+        const auto tokens = tokenize(source, trivia_mode::in_stream, operator_mode::maximal_munch);
+        auto parser       = parser_t{ tokens };
+        auto id           = ast::identifier_node{};
+        id.push(parser);
+
+        auto source2       = source_code(u8"a::b::c;");
+        const auto tokens2 = tokenize(source2);
+        auto parser2       = parser_t{ tokens2 };
+        auto id2           = ast::identifier_node{};
+        id2.push(parser2);
+
+        expect(tokens.size() == 6);
+        expect(id == id2);
+    };
+
     "identifier_node does not ignore whitespace"_test = [] {
         auto source1       = source_code(u8"ab c");
         const auto tokens1 = tokenize(source1);
@@ -0,0 +1,152 @@
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "hycc/incremental_tokenizer.hpp"
+#include "hycc/tokenizer.hpp"
+
+#include "token_buffer_comparison.hpp"
+
+/// Checks that retokenize gives identical tokens to tokenize after replacing
+/// \p removed code units at \p offset of \p str with \p inserted.
+void expect_same_as_tokenize(const std::u8string_view str,
+                             const std::size_t offset,
+                             const std::size_t removed,
+                             const std::u8string_view inserted) {
+    using namespace boost::ut;
+
+    auto edited_str = std::u8string{ str };
+    edited_str.replace(offset, removed, inserted);
+
+    using enum hycc::trivia_mode;
+    using enum hycc::operator_mode;
+    constexpr auto configurations = std::array{ std::pair{ in_stream, single_character },
+                                                std::pair{ side_table, single_character },
+                                                std::pair{ in_stream, maximal_munch },
+                                                std::pair{ side_table, maximal_munch } };
+    for (const auto& [mode, operators] : configurations) {
+        auto source         = hycc::source_code{ std::u8string{ str } };
+        auto edited         = hycc::source_code{ std::u8string{ edited_str } };
+        const auto previous = hycc::tokenize(source, mode, operators);
+        const auto expected = hycc::tokenize(edited, mode, operators);
+
+        const auto edit = hycc::text_edit{ offset, removed, inserted.size() };
+        const auto got  = hycc::retokenize(previous, edited, edit);
+
+        const auto at = std::format("source:\n{}\nedited:\n{}",
+                                    hycc::support::printable(str),
+                                    hycc::support::printable(edited_str));
+
+        // Retokenizing in place has to give the same result as retokenizing a copy.
+        auto edited_in_place = hycc::source_code{ std::u8string{ edited_str } };
+        const auto in_place =
+            hycc::retokenize(hycc::tokenize(source, mode, operators), edited_in_place, edit);
+        hycc::support::expect_same_tokens(got, in_place, at);
+        expect(got.source_sv() == in_place.source_sv()) << at;
+
+        // Symbol ids may differ, as previous symbols are kept, but the names may not.
+        hycc::support::expect_same_tokens(got,
+                                          expected,
+                                          at,
+                                          hycc::support::symbol_comparison::by_name);
+    }
+}
+
+int main() {
+    using namespace boost::ut;
+    using namespace hycc;
+
+    "edit inside identifier is retokenized"_test = [] {
+        expect_same_as_tokenize(u8"foo bar baz", 5, 0, u8"x");
+        expect_same_as_tokenize(u8"foo bar baz", 4, 3, u8"qux");
+        expect_same_as_tokenize(u8"foo bar baz", 3, 1, u8"");
+        expect_same_as_tokenize(u8"foo bar baz", 0, 0, u8"+");
+        expect_same_as_tokenize(u8"foo bar baz", 11, 0, u8" ");
+    };
+
+    "edit can open and close comments and literals"_test = [] {
+        expect_same_as_tokenize(u8"a /* b */ c d\ne", 2, 2, u8"");
+        expect_same_as_tokenize(u8"a / b */ c d\ne", 3, 0, u8"*");
+        expect_same_as_tokenize(u8"a \"b c\" d e", 2, 1, u8"");
+        expect_same_as_tokenize(u8"a b\" c d e", 2, 0, u8"\"");
+        expect_same_as_tokenize(u8"a \"b\\\" c\" d", 4, 1, u8"");
+        expect_same_as_tokenize(u8"a b c d e", 4, 0, u8"/*");
+    };
+
+    "line comment can be joined with the following line comment"_test = [] {
+        expect_same_as_tokenize(u8"a // one\n/ two\nb", 10, 0, u8"/");
+        expect_same_as_tokenize(u8"a // one\n// two\nb", 9, 1, u8"");
+        expect_same_as_tokenize(u8"a // one\n\n// two\nb", 8, 1, u8"");
+    };
+
+    "edit which does not match the sources throws"_test = [] {
+        auto source         = source_code{ u8"abc" };
+        auto edited         = source_code{ u8"abcd" };
+        const auto previous = tokenize(source);
+        expect(throws<std::invalid_argument>(
+            [&] { [[maybe_unused]] auto _ = retokenize(previous, edited, { 4, 0, 1 }); }));
+        expect(throws<std::invalid_argument>(
+            [&] { [[maybe_unused]] auto _ = retokenize(previous, edited, { 0, 0, 2 }); }));
+    };
+
+    "retokenize appends to the symbol table of previous"_test = [] {
+        auto source   = source_code{ u8"foo bar baz" };
+        auto previous = tokenize(source);
+        const auto ids = std::array{ previous[0].symbol, previous[2].symbol, previous[4].symbol };
+
+        auto edited     = source_code{ u8"foo qux bar baz" };
+        const auto next = retokenize(std::move(previous), edited, { 4, 0, 4 });
+        expect(next.size() == 7uz);
+        // Identifiers after the edit are not tokenized again, so they keep their symbols.
+        expect(next[0].symbol == ids[0]);
+        expect(next[4].symbol == ids[1]);
+        expect(next[6].symbol == ids[2]);
+        expect(next.symbols().name(next[2].symbol) == u8"qux");
+        expect(next.sv(next[2]) == u8"qux");
+    };
+
+    "random edits are retokenized identically"_test = [] {
+        constexpr auto alphabet = std::u8string_view{ u8" \n\n/*\"'\\a1+;<=>:\xc3\xa9\r" };
+        auto seed               = std::uint32_t{ 12345 };
+        auto random             = [&] {
+            seed = seed * 1664525u + 1013904223u;
+            return seed >> 16;
+        };
+        auto random_str = [&](const std::uint32_t max_length) {
+            auto str          = std::u8string{};
+            const auto length = random() % max_length;
+            for ([[maybe_unused]] const auto _ : std::views::iota(0u, length)) {
+                str.push_back(alphabet[random() % alphabet.size()]);
+            }
+            return str;
+        };
+
+        for ([[maybe_unused]] const auto _ : std::views::iota(0, 500)) {
+            const auto str      = random_str(80);
+            const auto offset   = random() % (str.size() + 1);
+            const auto removed  = random() % (str.size() - offset + 1);
+            const auto inserted = random_str(4);
+            expect_same_as_tokenize(str, offset, removed, inserted);
+        }
+    };
+
+    "edit in long source is retokenized identically"_test = [] {
+        auto str = std::u8string{};
+        for (const auto i : std::views::iota(0, 200)) {
+            str += u8"foo bar /* comment */ \"literal\" // line comment\n";
+            if (i % 50 == 0) str += u8"1 + 2\n";
+        }
+        expect_same_as_tokenize(str, 1000, 3, u8"x");
+        expect_same_as_tokenize(str, 1000, 0, u8"/*");
+        expect_same_as_tokenize(str, 5000, 0, u8"\"");
+        expect_same_as_tokenize(str, str.size() / 2, 100, u8"");
+    };
+}
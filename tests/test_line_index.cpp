@@ -0,0 +1,74 @@
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <cstddef>
+#include <format>
+#include <ranges>
+#include <string>
+#include <string_view>
+
+#include "hycc/line_index.hpp"
+
+/// Reference implementation which tracks row and column character by character.
+constexpr auto naive_position_of(const std::u8string_view code, const std::size_t offset) {
+    auto position = hycc::source_position{ 0, 1 };
+    for (const auto i : std::views::iota(0uz, offset + 1)) {
+        if (code[i] == u8'\n') {
+            ++position.row;
+            position.column = 0;
+        } else if (i != 0) {
+            ++position.column;
+        }
+    }
+    return position;
+}
+
+int main() {
+    using namespace boost::ut;
+    using namespace hycc;
+
+    "line_index can be constructed"_test = [] {
+        expect(nothrow([] { [[maybe_unused]] auto _ = line_index{ u8"" }; }));
+    };
+
+    "line_index can be used at compile time"_test = [] {
+        static_assert(line_index{ u8"a\nb" }.position_of(2) == source_position{ 1, 1 });
+        static_assert(line_index{ u8"a\nb\n" }.rows() == 3);
+    };
+
+    "first row has virtual newline"_test = [] {
+        const auto lines = line_index{ u8"abc" };
+        expect(lines.position_of(0) == source_position{ 0, 1 });
+        expect(lines.position_of(2) == source_position{ 0, 3 });
+        expect(lines.rows() == 1);
+    };
+
+    "newline is at column 0 of its row"_test = [] {
+        const auto lines = line_index{ u8"a\n\nbc\n" };
+        expect(lines.position_of(1) == source_position{ 1, 0 });
+        expect(lines.position_of(2) == source_position{ 2, 0 });
+        expect(lines.position_of(3) == source_position{ 2, 1 });
+        expect(lines.position_of(4) == source_position{ 2, 2 });
+        expect(lines.position_of(5) == source_position{ 3, 0 });
+        expect(lines.rows() == 4);
+    };
+
+    "line_index agrees with tracking every character"_test = [] {
+        // Long and irregular enough to span multiple vector registers and a scalar tail.
+        auto code = std::u8string{};
+        for (const auto i : std::views::iota(0uz, 500uz)) {
+            code.push_back((i * i) % 7 == 3 or i % 31 == 0 ? u8'\n' : u8'x');
+        }
+
+        const auto lines = line_index{ code };
+        for (const auto offset : std::views::iota(0uz, code.size())) {
+            const auto got      = lines.position_of(offset);
+            const auto expected = naive_position_of(code, offset);
+            expect(got == expected) << std::format("at offset {} expected [{}:{}], got [{}:{}]",
+                                                   offset,
+                                                   expected.row,
+                                                   expected.column,
+                                                   got.row,
+                                                   got.column);
+        }
+    };
+}
@@ -0,0 +1,104 @@
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <sys/stat.h>
+
+#include "hycc/mapped_file.hpp"
+#include "hycc/tokenizer.hpp"
+
+/// File in temporary directory which is removed at the end of scope.
+class temporary_file {
+    std::filesystem::path path_;
+
+  public:
+    explicit temporary_file(const std::string& name, const std::u8string_view content)
+        : path_{ std::filesystem::temp_directory_path() / name } {
+        auto file = std::ofstream{ path_, std::ios::binary };
+        file.write(reinterpret_cast<const char*>(content.data()),
+                   static_cast<std::streamsize>(content.size()));
+    }
+    temporary_file(const temporary_file&)            = delete;
+    temporary_file& operator=(const temporary_file&) = delete;
+    ~temporary_file() { std::filesystem::remove(path_); }
+
+    [[nodiscard]] auto path() const -> const std::filesystem::path& { return path_; }
+};
+
+int main() {
+    using namespace boost::ut;
+    using namespace hycc;
+
+    "mapped_file maps content of file"_test = [] {
+        const auto file   = temporary_file{ "hycc_test_mapped_file_1", u8"foo\nbar" };
+        const auto mapped = mapped_file{ file.path() };
+        expect(mapped.sv() == u8"foo\nbar");
+    };
+
+    "mapped_file can map empty file"_test = [] {
+        const auto file   = temporary_file{ "hycc_test_mapped_file_2", u8"" };
+        const auto mapped = mapped_file{ file.path() };
+        expect(mapped.sv().empty());
+    };
+
+    "mapped_file throws if file does not exist"_test = [] {
+        expect(throws<std::system_error>([] {
+            [[maybe_unused]] auto _ = mapped_file{ "/hycc/this/file/does/not/exist" };
+        }));
+    };
+
+    "mapped_file throws if file is not a regular file"_test = [] {
+        const auto fifo = std::filesystem::temp_directory_path() / "hycc_test_mapped_file_fifo";
+        std::filesystem::remove(fifo);
+        expect(::mkfifo(fifo.c_str(), 0600) == 0);
+        expect(throws<std::system_error>([&] { [[maybe_unused]] auto _ = mapped_file{ fifo }; }));
+        std::filesystem::remove(fifo);
+
+        expect(throws<std::system_error>([] {
+            [[maybe_unused]] auto _ = mapped_file{ std::filesystem::temp_directory_path() };
+        }));
+    };
+
+    "moved mapped_file keeps the mapping"_test = [] {
+        const auto file = temporary_file{ "hycc_test_mapped_file_3", u8"abc" };
+        auto mapped1    = mapped_file{ file.path() };
+        const auto sv   = mapped1.sv();
+        auto mapped2    = std::move(mapped1);
+        expect(mapped2.sv() == u8"abc");
+        expect(mapped2.sv().data() == sv.data());
+    };
+
+    "source_code from file is tokenized like source_code from string"_test = [] {
+        constexpr auto code = std::u8string_view{ u8"foo bar\n(123) + \"lit\"" };
+        const auto file     = temporary_file{ "hycc_test_mapped_file_4", code };
+
+        auto from_string    = source_code{ std::u8string{ code } };
+        const auto expected = tokenize(from_string);
+
+        auto from_file = source_code::from_file(file.path());
+        expect(from_file.sv() == code);
+        const auto got = tokenize(from_file);
+
+        expect(got.size() == expected.size());
+        for (const auto [g, e] : std::views::zip(got, expected)) {
+            expect(g == e);
+            expect(got.sv(g) == expected.sv(e));
+            expect(got.position(g) == expected.position(e));
+        }
+    };
+
+    "tokens keep mapped file alive"_test = [] {
+        const auto file = temporary_file{ "hycc_test_mapped_file_5", u8"foo bar" };
+        const auto tokens = [&] {
+            auto source = source_code::from_file(file.path());
+            return tokenize(source);
+        }();
+        expect(tokens.size() == 3);
+        expect(tokens.sv(tokens[2]) == u8"bar");
+    };
+}
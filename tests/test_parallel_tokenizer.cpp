@@ -0,0 +1,119 @@
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory_resource>
+#include <ranges>
+#include <string>
+#include <string_view>
+
+#include "hycc/parallel_tokenizer.hpp"
+#include "hycc/tokenizer.hpp"
+
+#include "token_buffer_comparison.hpp"
+
+/// Checks that tokenize_parallel gives identical tokens to tokenize with any number of threads.
+void expect_same_as_tokenize(const std::u8string_view str,
+                             const hycc::operator_mode operators =
+                                 hycc::operator_mode::single_character) {
+    for (const auto mode : hycc::support::trivia_modes) {
+        auto source         = hycc::source_code{ std::u8string{ str } };
+        const auto expected = hycc::tokenize(source, mode, operators);
+
+        for (const auto threads : std::views::iota(1uz, 12uz)) {
+            const auto got = hycc::tokenize_parallel(source, mode, operators, threads, 1);
+            const auto at  = std::format("{} threads, source:\n{}",
+                                         threads,
+                                         hycc::support::printable(str));
+            hycc::support::expect_same_tokens(got, expected, at);
+        }
+    }
+}
+
+int main() {
+    using namespace boost::ut;
+    using namespace hycc;
+    using enum operator_mode;
+
+    "chunks begin after newline"_test = [] {
+        const auto boundaries = detail::chunk_boundaries(u8"aa\nbb\ncc\ndd", 4);
+        expect(std::ranges::equal(boundaries, std::array{ 0uz, 3uz, 6uz, 9uz, 11uz }));
+
+        const auto one_line = detail::chunk_boundaries(u8"abcdef", 4);
+        expect(std::ranges::equal(one_line, std::array{ 0uz, 6uz }));
+
+        const auto empty = detail::chunk_boundaries(u8"", 4);
+        expect(std::ranges::equal(empty, std::array{ 0uz }));
+    };
+
+    "empty source can be tokenized in parallel"_test = [] {
+        auto source       = source_code{ u8"" };
+        const auto tokens =
+            tokenize_parallel(source, trivia_mode::in_stream, single_character, 4, 1);
+        expect(tokens.empty());
+    };
+
+    "tokens are allocated from the given memory resource"_test = [] {
+        auto resource = std::pmr::monotonic_buffer_resource{};
+        auto source   = source_code{ u8"a\nb /* c */\nd\n" };
+        for (const auto mode : { trivia_mode::in_stream, trivia_mode::side_table }) {
+            const auto expected = tokenize(source, mode);
+            const auto tokens =
+                tokenize_parallel(source, mode, single_character, 3, 1, &resource);
+            expect(tokens.resource() == &resource);
+            expect(std::ranges::equal(tokens.tokens(), expected.tokens()));
+        }
+        const auto default_allocated =
+            tokenize_parallel(source, trivia_mode::in_stream, single_character, 3, 1);
+        expect(default_allocated.resource() == nullptr);
+    };
+
+    "operators are munched in every chunk"_test = [] {
+        constexpr auto str =
+            std::u8string_view{ u8"x--\n--y\na&&b\np->q\na::b /* c\n->*/ ::c\nx<=>y\n" };
+        expect_same_as_tokenize(str, maximal_munch);
+        expect_same_as_tokenize(str, single_character);
+    };
+
+    "whitespace and line comments are joined over chunk boundaries"_test = [] {
+        expect_same_as_tokenize(u8"a\n\n  \nb\n c\n");
+        expect_same_as_tokenize(u8"a // one\n// two\n// three\nb\n//\n");
+        expect_same_as_tokenize(u8"a\n+b\n-\nc");
+    };
+
+    "literals and block comments are continued over chunk boundaries"_test = [] {
+        expect_same_as_tokenize(u8"a \"multi\nline\n\\\"literal\n\" b\nc\n");
+        expect_same_as_tokenize(u8"a /* multi\n line\n // comment\n*/ b\n/*/\nc\n");
+        expect_same_as_tokenize(u8"a\n'unterminated\nliteral\n");
+        expect_same_as_tokenize(u8"a\n/* unterminated\ncomment\n");
+    };
+
+    "literals and block comments can span many chunks"_test = [] {
+        expect_same_as_tokenize(u8"a /*\n\n*\n/\n\n*/ b /*\nc\n*/\n*/\n");
+        expect_same_as_tokenize(u8"a '''raw\n''\n'\n\\\n'''b\n''\n'''\n");
+        expect_same_as_tokenize(u8"a `x\\\n\\`\n`\n\n` b\n");
+        // Only the first invalid code unit of a literal is reported.
+        expect_same_as_tokenize(u8"a \"x\n\xff\n\n\xfe\" b\n\"\xff\n\n");
+        expect_same_as_tokenize(u8"a \"\xff\n\n\xfe\n\" b\n");
+    };
+
+    "random sources are tokenized identically"_test = [] {
+        constexpr auto alphabet = std::u8string_view{ u8" \n\n/*\"'\\a1+;\xc3\xa9\r" };
+        auto seed               = std::uint32_t{ 12345 };
+        auto random             = [&] {
+            seed = seed * 1664525u + 1013904223u;
+            return seed >> 16;
+        };
+
+        for ([[maybe_unused]] const auto _ : std::views::iota(0, 200)) {
+            auto str          = std::u8string{};
+            const auto length = random() % 60;
+            for ([[maybe_unused]] const auto __ : std::views::iota(0u, length)) {
+                str.push_back(alphabet[random() % alphabet.size()]);
+            }
+            expect_same_as_tokenize(str);
+        }
+    };
+}
@@ -1,26 +1,52 @@
 #include <boost/ut.hpp> // import boost.ut;
 
 #include <algorithm>
+#include <array>
 #include <concepts>
+#include <cstddef>
 #include <format>
+#include <functional>
 #include <ranges>
 #include <source_location>
 #include <span>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "hycc/ast.hpp"
 #include "hycc/parser.hpp"
 #include "hycc/tokenizer.hpp"
 
+// Replaces global operator new and delete of this test to count allocations.
+#include "allocation_counter.hpp"
+
+/// Alternatives of pattern_set have to be in static storage.
+namespace alternatives {
+
+using hycc::token_pattern;
+using hycc::token_type;
+
+constexpr auto keyword_in = std::array{ token_pattern{ token_type::identifier, u8"in" } };
+constexpr auto plus_plus  = std::array{ token_pattern{ token_type::operator_token, u8"+" },
+                                        token_pattern{ token_type::operator_token, u8"+" } };
+constexpr auto plus       = std::array{ token_pattern{ token_type::operator_token, u8"+" } };
+constexpr auto named_abc  = std::array{ token_pattern{ token_type::identifier, u8"abc" } };
+constexpr auto identifier = std::array{ token_type::identifier };
+
+} // namespace alternatives
+
 void expect_token(const hycc::token_pattern& expected,
                   const hycc::token& got,
+                  const hycc::token_buffer& buffer,
                   const std::source_location loc = std::source_location::current()) {
     const auto loc_info     = std::format("[actually at: {}]\n\n\t", loc.line());
     const auto error_end    = std::format("\n");
     const auto expected_str = std::string{ expected.sv.begin(), expected.sv.end() };
-    const auto got_str      = std::string{ got.sv_in_source.begin(), got.sv_in_source.end() };
+    const auto got_sv       = buffer.sv(got);
+    const auto got_str      = std::string{ got_sv.begin(), got_sv.end() };
 
     boost::ut::expect(expected.type == got.type)
         << loc_info
@@ -30,16 +56,18 @@ void expect_token(const hycc::token_pattern& expected,
                        got_str)
         << error_end;
 
-    boost::ut::expect(expected.sv == got.sv_in_source)
+    boost::ut::expect(expected.sv == got_sv)
         << loc_info << std::format("expected: {}, got {}", expected_str, got_str) << error_end;
 }
 
 void expect_token(const hycc::token_type expected,
                   const hycc::token& got,
+                  const hycc::token_buffer& buffer,
                   const std::source_location loc = std::source_location::current()) {
     const auto loc_info  = std::format("[actually at: {}]\n\n\t", loc.line());
     const auto error_end = std::format("\n");
-    const auto got_str   = std::string{ got.sv_in_source.begin(), got.sv_in_source.end() };
+    const auto got_sv    = buffer.sv(got);
+    const auto got_str   = std::string{ got_sv.begin(), got_sv.end() };
 
     boost::ut::expect(expected == got.type)
         << loc_info
@@ -50,13 +78,40 @@ void expect_token(const hycc::token_type expected,
         << error_end;
 }
 
+[[nodiscard]] constexpr auto pattern_type(const hycc::token_pattern& p) { return p.type; }
+[[nodiscard]] constexpr auto pattern_type(const hycc::token_type p) { return p; }
+
+/// Is \p matched a subspan of the tokens of \p buffer.
+[[nodiscard]] bool refers_to_buffer(const hycc::matched_tokens matched,
+                                    const hycc::token_buffer& buffer) {
+    const auto tokens = buffer.tokens();
+    return std::less_equal<>{}(tokens.data(), matched.data())
+           and std::less_equal<>{}(matched.data() + matched.size(), tokens.data() + tokens.size());
+}
+
+/// Matched tokens include whitespace skipped between them in trivia_mode::in_stream,
+/// so whitespace is compared only if \p expected has whitespace.
 template<hycc::token_matchable T>
 void expect_tokens(const std::span<T const> expected,
-                   const std::span<hycc::token const> got,
+                   const hycc::matched_tokens matched,
+                   const hycc::token_buffer& buffer,
                    const std::source_location loc = std::source_location::current()) {
+    boost::ut::expect(refers_to_buffer(matched, buffer))
+        << std::format("[actually at: {}]\n\n\tmatched tokens are not in the buffer", loc.line());
+
+    const auto skip_whitespace = std::ranges::none_of(expected, [](const T& p) {
+        return pattern_type(p) == hycc::token_type::whitespace;
+    });
+    const auto is_compared = [&](const hycc::token& x) {
+        return not skip_whitespace or x.type != hycc::token_type::whitespace;
+    };
+    auto significant       = matched | std::views::filter(is_compared);
+    const auto got         = std::vector<hycc::token>(significant.begin(), significant.end());
+
     const auto got_str = std::ranges::fold_left_first(
-        got | std::views::transform([](const hycc::token& x) {
-            return std::string{ x.sv_in_source.begin(), x.sv_in_source.end() };
+        got | std::views::transform([&](const hycc::token& x) {
+            const auto sv = buffer.sv(x);
+            return std::string{ sv.begin(), sv.end() };
         }),
         [](std::string lhs, std::string rhs) { return lhs += "\n" + rhs; });
 
@@ -67,8 +122,9 @@ void expect_tokens(const std::span<T const> expected,
                        got.size(),
                        got_str.value_or("[no tokens]"));
 
-    std::ranges::for_each(std::views::zip(expected, got),
-                          [](const auto& x) { expect_token(std::get<0>(x), std::get<1>(x)); });
+    std::ranges::for_each(std::views::zip(expected, got), [&](const auto& x) {
+        expect_token(std::get<0>(x), std::get<1>(x), buffer);
+    });
 }
 
 /// Helper to deduce type for the span version.
@@ -77,10 +133,12 @@ template<std::ranges::range R>
         std::span<std::ranges::range_value_t<R> const>{ std::forward<R>(r) };
     }
 void expect_tokens(R&& expected,
-                   const std::span<hycc::token const> got,
+                   const hycc::matched_tokens matched,
+                   const hycc::token_buffer& buffer,
                    const std::source_location loc = std::source_location::current()) {
     expect_tokens(std::span<std::ranges::range_value_t<R> const>{ std::forward<R>(expected) },
-                  got,
+                  matched,
+                  buffer,
                   loc);
 }
 
@@ -94,6 +152,65 @@ int main() {
         expect(nothrow([&] { [[maybe_unused]] auto _ = parser_t{ tokens }; }));
     };
 
+    "syntax_error reports row and column of the token"_test = [] {
+        auto source        = source_code{ u8"123\n  abc" };
+        const auto tokens  = tokenize(source);
+        auto parser        = parser_t{ tokens };
+        const auto pattern = std::vector{ token_type::integer, token_type::whitespace };
+        expect(parser.match_and_consume(pattern, false).has_value());
+
+        auto what = std::string{};
+        try {
+            parser.throw_syntax_error();
+        } catch (const syntax_error& e) { what = e.what(); }
+        expect(what == "syntax error at [1:3]: abc");
+    };
+
+    "parser_t in recover mode stores syntax errors instead of throwing"_test = [] {
+        auto source       = source_code{ u8"a { b; } c; }" };
+        const auto tokens = tokenize(source);
+        auto parser       = parser_t{ tokens, error_mode::recover };
+
+        auto error = parse_result{};
+        expect(nothrow([&] { error = parser.report_syntax_error(); }));
+        expect(not error.has_value()
+               and error.error().message(tokens) == "syntax error at [0:1]: a");
+
+        const auto skipped = parser.synchronize();
+        expect_tokens(std::vector<token_pattern>{ { token_type::identifier, u8"a" },
+                                                  { token_type::semantic_scope_operator, u8"{" },
+                                                  { token_type::identifier, u8"b" },
+                                                  { token_type::semantic_scope_operator, u8";" },
+                                                  { token_type::semantic_scope_operator, u8"}" },
+                                                  { token_type::identifier, u8"c" },
+                                                  { token_type::semantic_scope_operator, u8";" } },
+                      skipped,
+                      tokens);
+
+        // Synchronization stops before } which closes the current scope.
+        expect(parser.synchronize().empty());
+        expect(not parser.all_parsed());
+        expect(parser.diagnostics().size() == 1uz);
+    };
+
+    "parser_t restores checkpoints"_test = [] {
+        auto source       = source_code{ u8"a b ; c" };
+        const auto tokens = tokenize(source);
+        auto parser       = parser_t{ tokens, error_mode::recover };
+
+        const auto start = parser.checkpoint();
+        expect(parser.match_and_consume(std::array{ token_type::identifier }).has_value());
+        [[maybe_unused]] const auto _ = parser.report_syntax_error();
+        expect(parser.checkpoint() != start);
+        expect(parser.diagnostics().size() == 1uz);
+
+        parser.restore(start);
+        expect(parser.checkpoint() == start);
+        expect(parser.diagnostics().empty());
+        const auto matched = parser.match_and_consume(std::array{ token_type::identifier });
+        expect(matched.has_value() and tokens.sv(matched->front()) == u8"a");
+    };
+
     "parser_t can match patterns"_test = [] {
         auto source        = source_code{ u8"123" };
         const auto tokens  = tokenize(source);
@@ -101,7 +218,7 @@ int main() {
         const auto pattern = std::vector<token_pattern>{ { token_type::integer, u8"123" } };
         const auto matched = parser.match_and_consume(pattern);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t consumes matched tokens"_test = [] {
@@ -111,7 +228,7 @@ int main() {
         const auto pattern  = std::vector<token_pattern>{ { token_type::integer, u8"123" } };
         const auto matched1 = parser.match_and_consume(pattern);
         expect(matched1.has_value());
-        expect_tokens(pattern, matched1.value());
+        expect_tokens(pattern, matched1.value(), tokens);
         const auto matched2 = parser.match_and_consume(pattern);
         expect(not matched2.has_value());
         expect(parser.all_parsed());
@@ -124,7 +241,7 @@ int main() {
         const auto pattern = std::vector<token_pattern>{ { token_type::integer, u8"123" } };
         const auto matched = parser.match_and_consume(pattern);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t can match whitespace"_test = [] {
@@ -138,7 +255,27 @@ int main() {
         };
         const auto matched = parser.match_and_consume(pattern, false);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
+    };
+
+    "parser_t matches trivia of side table as whitespace"_test = [] {
+        auto source       = source_code{ u8" a /* c */ b\n" };
+        const auto tokens = tokenize(source, trivia_mode::side_table);
+        auto parser       = parser_t{ tokens };
+
+        const auto leading = parser.match_and_consume(std::array{ token_type::whitespace }, false);
+        expect(leading.has_value() and leading->empty());
+        const auto pattern = std::vector<token_pattern>{ { token_type::identifier, u8"a" },
+                                                         { token_type::whitespace, u8" /* c */ " },
+                                                         { token_type::identifier, u8"b" },
+                                                         { token_type::whitespace, u8"\n" } };
+        const auto matched = parser.match_and_consume(pattern, false);
+        expect(matched.has_value());
+        // Whitespace is not stored with the tokens, so only the identifiers are in the span.
+        expect(matched.has_value() and matched->data() == tokens.tokens().data()
+               and matched->size() == 2uz);
+        expect(parser.all_parsed());
+        expect(not parser.match_and_consume(std::array{ token_type::whitespace }, false));
     };
 
     "parser_t can match all token types"_test = [] {
@@ -153,7 +290,7 @@ int main() {
         };
         const auto matched = parser.match_and_consume(pattern, false);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t can match all token types in str littered with whitespace"_test = [] {
@@ -170,7 +307,7 @@ int main() {
             };
         const auto matched = parser.match_and_consume(pattern);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t matching can fail gracefully"_test = [] {
@@ -213,7 +350,7 @@ int main() {
         const auto pattern2 = std::vector<token_pattern>{ { token_type::integer, u8"123" } };
         const auto matched2 = parser.match_and_consume(pattern2);
         expect(matched2.has_value());
-        expect_tokens(pattern2, matched2.value());
+        expect_tokens(pattern2, matched2.value(), tokens);
         expect(parser.all_parsed());
 
         const auto pattern3 = std::vector<token_pattern>{ { token_type::integer, u8"123" } };
@@ -248,7 +385,7 @@ int main() {
             };
         const auto matched2 = parser.match_and_consume(pattern2);
         expect(matched2.has_value());
-        expect_tokens(pattern2, matched2.value());
+        expect_tokens(pattern2, matched2.value(), tokens);
 
         const auto pattern3 =
             std::vector<token_pattern>{ { token_type::integer, u8"1" },
@@ -270,12 +407,12 @@ int main() {
 
         const auto matched1 = parser.match_and_consume(pattern);
         expect(matched1.has_value());
-        expect_tokens(pattern, matched1.value());
+        expect_tokens(pattern, matched1.value(), tokens);
         expect(not parser.all_parsed());
 
         const auto matched2 = parser.match_and_consume(pattern);
         expect(matched2.has_value());
-        expect_tokens(pattern, matched2.value());
+        expect_tokens(pattern, matched2.value(), tokens);
         expect(parser.all_parsed());
     };
 
@@ -286,7 +423,7 @@ int main() {
         const auto pattern = std::vector{ token_type::integer };
         const auto matched = parser.match_and_consume(pattern);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t consumes matched tokens with type only patterns"_test = [] {
@@ -296,7 +433,7 @@ int main() {
         const auto pattern  = std::vector{ token_type::integer };
         const auto matched1 = parser.match_and_consume(pattern);
         expect(matched1.has_value());
-        expect_tokens(pattern, matched1.value());
+        expect_tokens(pattern, matched1.value(), tokens);
         const auto matched2 = parser.match_and_consume(pattern);
         expect(not matched2.has_value());
         expect(parser.all_parsed());
@@ -309,7 +446,7 @@ int main() {
         const auto pattern = std::vector{ token_type::integer };
         const auto matched = parser.match_and_consume(pattern);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t can match whitespace as type only"_test = [] {
@@ -320,7 +457,7 @@ int main() {
             std::vector{ token_type::whitespace, token_type::integer, token_type::whitespace };
         const auto matched = parser.match_and_consume(pattern, false);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t can match all token types as type only"_test = [] {
@@ -333,7 +470,7 @@ int main() {
                          token_type::operator_token, token_type::identifier };
         const auto matched = parser.match_and_consume(pattern, false);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t can match all type only token patterns in str littered with whitespace"_test = [] {
@@ -347,7 +484,7 @@ int main() {
                                           token_type::identifier };
         const auto matched = parser.match_and_consume(pattern);
         expect(matched.has_value());
-        expect_tokens(pattern, matched.value());
+        expect_tokens(pattern, matched.value(), tokens);
     };
 
     "parser_t matching can fail gracefully with type only patterns"_test = [] {
@@ -387,7 +524,7 @@ int main() {
         const auto pattern2 = std::vector{ token_type::integer };
         const auto matched2 = parser.match_and_consume(pattern2);
         expect(matched2.has_value());
-        expect_tokens(pattern2, matched2.value());
+        expect_tokens(pattern2, matched2.value(), tokens);
         expect(parser.all_parsed());
 
         const auto pattern3 = std::vector{ token_type::integer };
@@ -417,7 +554,7 @@ int main() {
 
         const auto matched2 = parser.match_and_consume(pattern2);
         expect(matched2.has_value());
-        expect_tokens(pattern2, matched2.value());
+        expect_tokens(pattern2, matched2.value(), tokens);
 
         const auto matched3 = parser.match_and_consume(pattern2);
         expect(not matched3.has_value());
@@ -466,7 +603,7 @@ int main() {
                                            token_pattern{ token_type::operator_token, u8"-" } };
 
         expect(matched.has_value());
-        expect_tokens(expected, matched.value());
+        expect_tokens(expected, matched.value(), tokens);
 
         expect(parser
                    .match_and_consume(
@@ -487,7 +624,7 @@ int main() {
                                            token_pattern{ token_type::operator_token, u8"-" } };
 
         expect(matched.has_value());
-        expect_tokens(expected, matched.value());
+        expect_tokens(expected, matched.value(), tokens);
 
         expect(parser
                    .match_and_consume(
@@ -510,7 +647,7 @@ int main() {
                                            token_pattern{ token_type::operator_token, u8"-" } };
 
         expect(matched.has_value());
-        expect_tokens(expected, matched.value());
+        expect_tokens(expected, matched.value(), tokens);
 
         expect(parser
                    .match_and_consume(
@@ -520,4 +657,197 @@ int main() {
                    .has_value());
         expect(parser.all_parsed());
     };
+
+    "parser_t alternates between skipping and matching whitespace"_test = [] {
+        auto source       = source_code{ u8"a  b c d;e" };
+        const auto tokens = tokenize(source);
+        auto parser       = parser_t{ tokens };
+
+        expect(parser.match_and_consume(std::vector{ token_type::identifier,
+                                                     token_type::whitespace },
+                                        false));
+        expect(not parser.match_and_consume(std::vector{ token_type::identifier,
+                                                         token_type::identifier },
+                                            false));
+        const auto matched = parser.match_and_consume(std::vector{ token_type::identifier,
+                                                                   token_type::identifier });
+        expect(matched.has_value());
+        expect(matched.has_value() and tokens.sv(matched.value().back()) == u8"c");
+
+        expect(parser.match_and_consume(std::vector{ token_type::whitespace }, false));
+        const auto skipped =
+            parser.consume_until(token_pattern{ token_type::semantic_scope_operator, u8";" });
+        expect(skipped.has_value());
+        expect(skipped.has_value() and skipped.value().size() == 1);
+        expect(parser.match_and_consume(std::vector{ token_type::identifier }, false));
+        expect(parser.all_parsed());
+        expect(not parser.match_and_consume(std::vector{ token_type::identifier }));
+    };
+
+    "parser_t matches tokens in place without allocating"_test = [] {
+        auto text = std::u8string{};
+        for (auto i = 0; i < 1000; ++i) text += u8"abc 123 /* x */ ;";
+        auto source = source_code{ std::move(text) };
+
+        for (const auto mode : { trivia_mode::in_stream, trivia_mode::side_table }) {
+            const auto tokens = tokenize(source, mode);
+            auto parser       = parser_t{ tokens };
+
+            static constexpr auto mismatch =
+                std::array{ token_type::identifier, token_type::identifier };
+            static constexpr auto with_whitespace =
+                std::array{ token_type::identifier, token_type::whitespace };
+            static constexpr auto semicolon =
+                token_pattern{ token_type::semantic_scope_operator, u8";" };
+
+            const auto allocations_before = hycc::support::allocations_so_far().allocations;
+            auto items                    = 0uz;
+            while (not parser.all_parsed()) {
+                const auto failed  = parser.match_and_consume(mismatch);
+                const auto matched = parser.match_and_consume(with_whitespace, false);
+                const auto skipped = parser.consume_until(semicolon);
+                if (failed or not matched or not skipped or skipped.value().size() != 1) break;
+                if (not refers_to_buffer(matched.value(), tokens)) break;
+                if (not refers_to_buffer(skipped.value(), tokens)) break;
+                if (tokens.sv(skipped.value().front()) != u8"123") break;
+                ++items;
+            }
+            const auto allocations = hycc::support::allocations_so_far().allocations;
+
+            expect(items == 1000uz);
+            expect(allocations == allocations_before)
+                << std::format("{} allocations while matching", allocations - allocations_before);
+        }
+    };
+
+    "pattern_set gives alternatives which may match the first token"_test = [] {
+        using namespace alternatives;
+        using set = pattern_set<keyword_in, plus_plus, plus, named_abc, identifier>;
+
+        auto source       = source_code{ u8"in + abc xyz 1" };
+        const auto tokens = tokenize(source, trivia_mode::side_table);
+        expect(tokens.size() == 5);
+
+        expect(set::candidates(tokens[0]) == 0b1'1001u);
+        expect(set::candidates(tokens[1]) == 0b0'0110u);
+        expect(set::candidates(tokens[2]) == 0b1'1000u);
+        expect(set::candidates(tokens[3]) == 0b1'1000u);
+        expect(set::candidates(tokens[4]) == 0u);
+    };
+
+    "parser_t matches the first matching alternative of pattern_set"_test = [] {
+        using namespace alternatives;
+        constexpr auto set = pattern_set<keyword_in, plus_plus, plus, named_abc, identifier>{};
+
+        auto source       = source_code{ u8"in ++ + abc xyz 1" };
+        const auto tokens = tokenize(source);
+        auto parser       = parser_t{ tokens };
+
+        for (const auto& [index, text] : { std::tuple{ 0uz, u8"in" },
+                                           std::tuple{ 1uz, u8"+" },
+                                           std::tuple{ 2uz, u8"+" },
+                                           std::tuple{ 3uz, u8"abc" },
+                                           std::tuple{ 4uz, u8"xyz" } }) {
+            const auto matched = parser.match_and_consume(set);
+            expect(matched.has_value() and matched->index == index);
+            expect(matched.has_value() and tokens.sv(matched->tokens.front()) == text);
+        }
+
+        expect(not parser.match_and_consume(set));
+        expect(not parser.all_parsed());
+        expect(parser.match_and_consume(std::array{ token_type::integer }).has_value());
+        expect(not parser.match_and_consume(set));
+    };
+
+    "parser_t in trivia side table mode matches whitespace between tokens"_test = [] {
+        auto source       = source_code{ u8"abc /* x */ 123 " };
+        const auto tokens = tokenize(source, trivia_mode::side_table);
+        expect(tokens.size() == 2);
+
+        auto parser = parser_t{ tokens };
+        expect(not parser.match_and_consume(std::vector{ token_type::identifier,
+                                                         token_type::integer },
+                                            false));
+
+        const auto pattern = std::vector{ token_type::identifier,
+                                          token_type::whitespace,
+                                          token_type::integer,
+                                          token_type::whitespace };
+        const auto matched = parser.match_and_consume(pattern, false);
+        expect(matched.has_value());
+        // Whitespace is matched from the side table, so only the tokens are in the span.
+        expect_tokens(std::vector{ token_type::identifier, token_type::integer },
+                      matched.value(),
+                      tokens);
+        expect(parser.all_parsed());
+
+        auto again = parser_t{ tokens };
+        const auto with_comment =
+            std::vector<token_pattern>{ { token_type::identifier, u8"abc" },
+                                        { token_type::whitespace, u8" /* x */ " } };
+        expect(again.match_and_consume(with_comment, false).has_value());
+    };
+
+    "parser_t in trivia side table mode can skip whitespace"_test = [] {
+        auto source       = source_code{ u8" abc  123" };
+        const auto tokens = tokenize(source, trivia_mode::side_table);
+        auto parser       = parser_t{ tokens };
+
+        expect(not parser.all_parsed());
+        expect(parser.match_and_consume(std::vector{ token_type::whitespace }, false));
+        const auto pattern = std::vector<token_pattern>{ { token_type::identifier, u8"abc" },
+                                                         { token_type::integer, u8"123" } };
+        const auto matched = parser.match_and_consume(pattern);
+        expect(matched.has_value());
+        expect_tokens(pattern, matched.value(), tokens);
+        expect(parser.all_parsed());
+    };
+
+    "parser_t in trivia side table mode can consume until pattern"_test = [] {
+        auto source       = source_code{ u8"a b;c" };
+        const auto tokens = tokenize(source, trivia_mode::side_table);
+        auto parser       = parser_t{ tokens };
+
+        const auto semicolon = token_pattern{ token_type::semantic_scope_operator, u8";" };
+        const auto matched   = parser.consume_until(semicolon, false);
+        expect(matched.has_value());
+        expect_tokens(std::vector{ token_type::identifier, token_type::identifier },
+                      matched.value(),
+                      tokens);
+
+        expect(not parser.consume_until(semicolon));
+        const auto rest = parser.match_and_consume(std::vector{ token_type::identifier }, false);
+        expect(rest.has_value());
+        expect(parser.all_parsed());
+    };
+
+    "global scope is parsed with work linear in its items"_test = [] {
+        // Actions executed and allocations made to parse global scope of \p items nested scopes.
+        const auto parse_work = [](const std::size_t items) {
+            auto text = std::u8string{};
+            for (auto i = 0uz; i < items; ++i) text += u8"{}\n";
+            auto source       = source_code{ std::move(text) };
+            const auto tokens = tokenize(source);
+            auto parser       = parser_t{ tokens };
+            auto global_scope = ast::scope_node{};
+            global_scope.mark_as_global_scope();
+            auto stack = ast::action_stack{ global_scope };
+
+            const auto allocations_before = hycc::support::allocations_so_far().allocations;
+            auto actions                  = 1uz;
+            while (not stack.run(parser, 1).has_value()) ++actions;
+            const auto allocations = hycc::support::allocations_so_far().allocations;
+
+            expect(global_scope.get_ordered_property().size() == items);
+            return std::pair{ actions, allocations - allocations_before };
+        };
+
+        const auto [small_actions, small_allocations] = parse_work(10'000);
+        const auto [large_actions, large_allocations] = parse_work(100'000);
+        // Linear work gives ratio of 10 and quadratic of 100.
+        expect(large_actions <= 11 * small_actions)
+            << std::format("10k items: {} actions, 100k items: {}", small_actions, large_actions);
+        expect(large_allocations <= 11 * small_allocations) << std::format(
+            "10k items: {} allocations, 100k items: {}", small_allocations, large_allocations);
+    };
 }
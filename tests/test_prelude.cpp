@@ -0,0 +1,54 @@
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+#include "hycc/prelude.hpp"
+#include "hycc/tokenizer.hpp"
+
+int main() {
+    using namespace boost::ut;
+    using namespace hycc;
+
+    "prelude is tokenized at compile time"_test = [] {
+        static_assert(detail::prelude_token_table.size() == detail::prelude_token_count);
+        static_assert(detail::prelude_token_table.front().type == token_type::identifier);
+        static_assert(detail::prelude_trivia_table.front().type == token_type::comment);
+        static_assert(detail::prelude_identifiers.front() == u8"void");
+        static_assert(std::ranges::find(detail::prelude_identifiers, u8"sizeof")
+                      != detail::prelude_identifiers.end());
+    };
+
+    "prelude tokens are the same as tokenized at run time"_test = [] {
+        auto source          = source_code{ std::u8string{ prelude_source } };
+        const auto tokenized = tokenize(source, trivia_mode::side_table);
+        const auto prelude   = prelude_tokens();
+
+        expect(prelude.source_sv() == prelude_source);
+        expect(prelude.mode() == trivia_mode::side_table);
+        expect(std::ranges::equal(prelude.tokens(), tokenized.tokens()));
+        expect(std::ranges::equal(prelude.trivia(), tokenized.trivia()));
+
+        expect(prelude.symbols().size() == tokenized.symbols().size());
+        for (auto i = 0uz; i < tokenized.symbols().size(); ++i) {
+            const auto id = first_identifier_id + static_cast<symbol_id>(i);
+            expect(prelude.symbols().name(id) == tokenized.symbols().name(id));
+        }
+    };
+
+    "prelude tokens are allocated from the given memory resource"_test = [] {
+        auto resource      = std::pmr::monotonic_buffer_resource{};
+        const auto prelude = prelude_tokens(&resource);
+        expect(prelude.resource() == &resource);
+        expect(prelude.size() == detail::prelude_token_count);
+    };
+
+    "prelude source is shared by every prelude_tokens"_test = [] {
+        const auto prelude1 = prelude_tokens();
+        const auto prelude2 = prelude_tokens();
+        expect(prelude1.source_sv().data() == prelude2.source_sv().data());
+        expect(prelude1.symbols().size() == prelude2.symbols().size());
+    };
+}
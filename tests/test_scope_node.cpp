@@ -1,9 +1,12 @@
 
 #include <boost/ut.hpp> // import boost.ut;
 
+#include <cstddef>
 #include <format>
 #include <ranges>
 #include <source_location>
+#include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -29,7 +32,8 @@ constexpr void
         [](hycc::ast::return_statement_node) { return " return_statement_node"; },
         [](hycc::ast::namespace_decleration_node) { return " namespace_decleration_node"; },
         [](hycc::ast::expression_node) { return " expression_node"; },
-        [](hycc::ast::data_decleration_node) { return " data_decleration_node"; }
+        [](hycc::ast::data_decleration_node) { return " data_decleration_node"; },
+        [](hycc::ast::error_node) { return " error_node"; }
 
     };
     auto error_msg = [&](const hycc::ast::ordered_property& e,
@@ -104,4 +108,100 @@ int main() {
                                 global_scope.get_ordered_property());
     };
 
+    "global scope_node recovers from syntax errors"_test = [] {
+        auto source       = source_code(u8"{ x; } } { a { b } c; {} } d");
+        const auto tokens = tokenize(source);
+        auto parser       = parser_t{ tokens, error_mode::recover };
+
+        auto global_scope = ast::scope_node{};
+        global_scope.mark_as_global_scope();
+
+        auto result = parse_result{};
+        expect(nothrow([&] { result = global_scope.push(parser); }));
+        expect(result.has_value());
+        expect_ordered_property({ ast::nested_scope{},
+                                  ast::error_node{ {} },
+                                  ast::nested_scope{},
+                                  ast::error_node{ {} } },
+                                global_scope.get_ordered_property());
+
+        const auto diagnostics = parser.diagnostics();
+        expect(diagnostics.size() == 4uz);
+        auto messages = std::vector<std::string>{};
+        for (const auto& d : diagnostics) messages.push_back(d.message(tokens));
+        expect(messages == std::vector<std::string>{ "syntax error at [0:3]: x",
+                                                     "syntax error at [0:8]: }",
+                                                     "syntax error at [0:12]: a",
+                                                     "syntax error at [0:28]: d" });
+
+        const auto& nested = std::get<ast::nested_scope>(global_scope.get_ordered_property()[2]);
+        expect_ordered_property({ ast::error_node{ {} }, ast::nested_scope{} },
+                                nested.get_ordered_property());
+    };
+
+    "scope_node fails in recover mode if tokens end before end of scope"_test = [] {
+        auto source       = source_code(u8"{ {} x");
+        const auto tokens = tokenize(source);
+        auto parser       = parser_t{ tokens, error_mode::recover };
+
+        auto global_scope = ast::scope_node{};
+        global_scope.mark_as_global_scope();
+
+        const auto result = global_scope.push(parser);
+        expect(not result.has_value());
+        expect(parser.diagnostics().size() == 2uz);
+        expect(not result.has_value() and result.error() == syntax_diagnostic{ std::nullopt });
+        expect(parser.all_parsed());
+    };
+
+    "deeply nested scope_node does not overflow the stack"_test = [] {
+        constexpr auto depth = 200'000uz;
+        auto text            = std::u8string(depth, u8'{') + std::u8string(depth, u8'}');
+        auto source          = source_code(std::move(text));
+        const auto tokens    = tokenize(source);
+        auto parser          = parser_t{ tokens };
+
+        auto global_scope = ast::scope_node{};
+        global_scope.mark_as_global_scope();
+        expect(global_scope.push(parser).has_value());
+        expect(parser.all_parsed());
+
+        const auto depth_of = [](const ast::scope_node& root) {
+            auto n = 0uz;
+            for (const ast::scope_node* scope = &root; not scope->get_ordered_property().empty();
+                 ++n) {
+                scope = &std::get<ast::nested_scope>(scope->get_ordered_property().front());
+            }
+            return n;
+        };
+        expect(depth_of(global_scope) == depth);
+
+        // Copies are made from a worklist too.
+        const auto copy = global_scope;
+        expect(copy.is_global_scope() and depth_of(copy) == depth);
+        auto assigned = ast::scope_node{};
+        assigned      = copy;
+        expect(depth_of(assigned) == depth);
+    };
+
+    "scope_node parsing can be paused and resumed"_test = [] {
+        auto source       = source_code(u8"{ {} } {");
+        const auto tokens = tokenize(source);
+        auto parser       = parser_t{ tokens, error_mode::recover };
+
+        auto global_scope = ast::scope_node{};
+        global_scope.mark_as_global_scope();
+        auto stack = ast::action_stack{ global_scope };
+
+        expect(not stack.run(parser, 2).has_value());
+        expect(stack.depth() == 3uz);
+        expect(not stack.run(parser, 1).has_value());
+        expect(stack.depth() == 2uz);
+
+        const auto result = stack.run(parser);
+        expect(result.has_value() and not result->has_value());
+        expect(stack.depth() == 0uz);
+        expect(parser.diagnostics().size() == 1uz);
+        expect(stack.run(parser) == result);
+    };
 }
@@ -1,9 +1,23 @@
 #include <boost/ut.hpp> // import boost.ut;
 
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "hycc/sstd.hpp"
 
+/// Value of an ownership read through its copy and a borrowed view.
+template<hycc::sstd::ownership_policy Policy>
+constexpr auto copied_value() -> int {
+    const auto ownership1 = hycc::sstd::make_shared_object<int, Policy>(42);
+    auto ownership2       = ownership1;
+    ownership2            = ownership1;
+    return ownership2.value() + ownership1.borrow().value();
+}
+
 int main() {
     using namespace boost::ut;
     using namespace hycc;
@@ -63,6 +77,99 @@ int main() {
         expect(ownership1.value().b == 2.3f);
     };
 
+    "ownership copy assignment releases the previous object"_test = [] {
+        struct resource {
+            std::shared_ptr<int> alive;
+        };
+
+        auto alive1     = std::make_shared<int>(1);
+        auto alive2     = std::make_shared<int>(2);
+        const auto weak = std::weak_ptr<int>{ alive1 };
+
+        auto ownership1       = sstd::make_shared_object<resource>(std::move(alive1));
+        const auto ownership2 = sstd::make_shared_object<resource>(std::move(alive2));
+        ownership1            = ownership2;
+        expect(weak.expired());
+        expect(*ownership1.value().alive == 2);
+
+        const auto& same = ownership1;
+        ownership1       = same;
+        expect(*ownership1.value().alive == 2);
+    };
+
+    "ownership move assignment releases the previous object"_test = [] {
+        struct resource {
+            std::shared_ptr<int> alive;
+        };
+
+        auto alive1     = std::make_shared<int>(1);
+        const auto weak = std::weak_ptr<int>{ alive1 };
+
+        auto ownership1 = sstd::make_shared_object<resource>(std::move(alive1));
+        auto ownership2 = sstd::make_shared_object<resource>(std::make_shared<int>(2));
+        ownership1      = std::move(ownership2);
+        expect(weak.expired());
+        expect(*ownership1.value().alive == 2);
+    };
+
+    "ownership can be used in constant expressions"_test = [] {
+        using enum sstd::ownership_policy;
+        static_assert(copied_value<single_threaded>() == 84);
+        static_assert(copied_value<atomic>() == 84);
+    };
+
+    "atomic ownership can be copied and destroyed on many threads"_test = [] {
+        struct resource {
+            std::shared_ptr<int> alive;
+        };
+
+        auto alive      = std::make_shared<int>(1);
+        const auto weak = std::weak_ptr<int>{ alive };
+        {
+            const auto ownership1 =
+                sstd::make_shared_object<resource, sstd::ownership_policy::atomic>(std::move(alive));
+
+            auto threads = std::vector<std::jthread>{};
+            for (auto i = 0; i < 8; ++i) {
+                threads.emplace_back([copy = ownership1] {
+                    for (auto j = 0; j < 10'000; ++j) {
+                        [[maybe_unused]] const auto another_copy = copy;
+                    }
+                });
+            }
+        }
+        expect(weak.expired());
+    };
+
+    "resource_allocator allocates from its resource or with std::allocator"_test = [] {
+        auto resource = std::pmr::monotonic_buffer_resource{};
+        auto vector1  = sstd::resource_vector<int>(&resource);
+        vector1.assign({ 1, 2, 3 });
+        expect(vector1.get_allocator().resource() == &resource);
+
+        // Copies use std::allocator like copies of std::pmr containers use the default resource.
+        const auto vector2 = vector1;
+        expect(vector2.get_allocator().resource() == nullptr);
+        expect(vector2 == vector1);
+
+        constexpr auto sum_in_constant_evaluation = [] {
+            auto v = sstd::resource_vector<int>{ 1, 2, 3 };
+            v.push_back(4);
+            return v[0] + v[1] + v[2] + v[3];
+        };
+        static_assert(sum_in_constant_evaluation() == 10);
+    };
+
+    "borrowed ownership refers to the object without owning it"_test = [] {
+        const auto ownership1 = sstd::make_shared_object<int>(3);
+        const auto borrowed   = ownership1.borrow();
+        expect(&borrowed.value() == &ownership1.value());
+
+        const auto object    = 4;
+        const auto borrowed2 = sstd::ownership<int, sstd::ownership_policy::borrowed>{ object };
+        expect(borrowed2.value() == 4);
+    };
+
     "limited truth can be created"_test = [] {
         auto limited_truth = sstd::limited_truth{ 42 };
         expect(limited_truth.get_truth());
@@ -103,4 +103,96 @@ int main() {
         expect(end_state.continuations == std::vector<std::string>{ "foo", "bar" });
         expect(end_state.ends == std::vector<std::string>{ "foo", "bar" });
     };
+
+    "state pattern matcher tries only patterns which can start at the peeked code unit"_test = [] {
+        using namespace state_pattern_matcher;
+        struct state_type {
+            std::string input        = "aab";
+            std::size_t pos          = 0;
+            std::string matched      = "";
+            int predicates_evaluated = 0;
+            constexpr void advance() { ++pos; }
+            [[nodiscard]] constexpr auto peek() const -> char { return input[pos]; }
+        };
+
+        struct a_pattern {
+            static constexpr bool can_start_with(const unsigned char c) { return c == 'a'; }
+            bool active = false;
+            auto operator()(predicate_tag, state_type& state) -> bool {
+                ++state.predicates_evaluated;
+                return state.input[state.pos] == 'a' and not active;
+            }
+            void operator()(begin_tag, state_type& state) {
+                active = true;
+                state.matched += "a";
+            }
+            void operator()(continuation_tag, state_type&) {}
+            void operator()(end_tag, state_type&) { active = false; }
+        };
+
+        struct b_pattern {
+            static constexpr bool can_start_with(const unsigned char c) { return c == 'b'; }
+            auto operator()(predicate_tag, state_type& state) -> bool {
+                ++state.predicates_evaluated;
+                return true;
+            }
+            void operator()(begin_tag, state_type& state) { state.matched += "b"; }
+            void operator()(continuation_tag, state_type&) {}
+            void operator()(end_tag, state_type&) {}
+        };
+
+        auto matcher         = create_matcher_for<state_type>(a_pattern{}, b_pattern{});
+        auto until           = [](const auto& state) { return state.pos == state.input.size(); };
+        const auto end_state = matcher(state_type{}, until);
+
+        expect(end_state.matched == "aab");
+        // One predicate to find a pattern for each code unit
+        // and one to check if "a" continues to the next code unit.
+        expect(end_state.predicates_evaluated == 5_i);
+    };
+
+    "state pattern matcher advances over runs consumed by pattern"_test = [] {
+        using namespace state_pattern_matcher;
+        struct state_type {
+            std::string input        = "aaaab";
+            std::size_t pos          = 0;
+            std::string matched      = "";
+            int predicates_evaluated = 0;
+            int continuations_called = 0;
+            constexpr void advance() { ++pos; }
+        };
+
+        struct run_pattern {
+            auto operator()(predicate_tag, state_type& state) -> bool {
+                ++state.predicates_evaluated;
+                return state.input[state.pos] == 'a';
+            }
+            void operator()(begin_tag, state_type& state) { state.matched += "["; }
+            void operator()(continuation_tag, state_type& state) { ++state.continuations_called; }
+            auto operator()(consume_tag, state_type& state) -> std::size_t {
+                return state.input.find_first_not_of('a', state.pos) - state.pos;
+            }
+            void operator()(end_tag, state_type& state) { state.matched += "]"; }
+        };
+
+        const auto other = sstd::overloaded{
+            [](predicate_tag, auto& state) static -> bool {
+                ++state.predicates_evaluated;
+                return true;
+            },
+            [](begin_tag, auto& state) static -> void { state.matched += "b"; },
+            [](continuation_tag, auto&) static -> void {},
+            [](end_tag, auto&) static -> void {}
+        };
+
+        auto matcher         = create_matcher_for<state_type>(run_pattern{}, other);
+        auto until           = [](const auto& state) { return state.pos == state.input.size(); };
+        const auto end_state = matcher(state_type{}, until);
+
+        expect(end_state.pos == 5uz);
+        expect(end_state.matched == "[]b");
+        expect(end_state.continuations_called == 0_i);
+        // Predicates are not evaluated inside the run.
+        expect(end_state.predicates_evaluated == 4_i);
+    };
 }
@@ -0,0 +1,84 @@
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <algorithm>
+#include <format>
+#include <functional>
+#include <ranges>
+#include <string>
+#include <string_view>
+
+#include "hycc/symbol_table.hpp"
+
+int main() {
+    using namespace boost::ut;
+    using namespace hycc;
+
+    "keyword hash is perfect"_test = [] {
+        for (const auto [i, keyword] : keywords | std::views::enumerate) {
+            expect(keyword_id(keyword) == first_keyword_id + static_cast<symbol_id>(i));
+        }
+        static_assert(keyword_id(u8"inout") == first_keyword_id + 1);
+        static_assert(not keyword_id(u8"int").has_value());
+        static_assert(not keyword_id(u8"").has_value());
+    };
+
+    "only keywords and single characters have fixed symbols"_test = [] {
+        static_assert(fixed_symbol_id(u8"forward") == keyword_id(u8"forward"));
+        static_assert(fixed_symbol_id(u8":") == symbol_id{ u8':' });
+        static_assert(fixed_symbol_id(u8"foo") == no_symbol);
+        static_assert(fixed_symbol_id(u8"constt") == no_symbol);
+        static_assert(fixed_symbol_id(u8"<=>") == first_operator_id);
+        static_assert(fixed_symbol_id(u8"<=>=") == no_symbol);
+    };
+
+    "multi character operators are ordered from longest to shortest"_test = [] {
+        const auto size_of = [](const std::u8string_view op) { return op.size(); };
+        expect(std::ranges::is_sorted(multi_character_operators, std::ranges::greater{}, size_of));
+        for (const auto [i, op] : multi_character_operators | std::views::enumerate) {
+            const auto id = first_operator_id + static_cast<symbol_id>(i);
+            expect(multi_character_operator_id(op) == id);
+            expect(symbol_table{}.name(id) == op);
+        }
+    };
+
+    "symbol_table interns identifiers in order of first occurrence"_test = [] {
+        auto symbols = symbol_table{};
+        const auto a = symbols.intern(u8"abc");
+        const auto b = symbols.intern(u8"def");
+        expect(a == first_identifier_id);
+        expect(b == first_identifier_id + 1);
+        expect(symbols.intern(u8"abc") == a);
+        expect(symbols.intern(u8"const") == keyword_id(u8"const"));
+        expect(symbols.size() == 2);
+
+        expect(symbols.name(a) == u8"abc");
+        expect(symbols.name(b) == u8"def");
+        expect(symbols.name(symbol_id{ u8'x' }) == u8"x");
+        expect(symbols.name(keyword_id(u8"move").value()) == u8"move");
+        expect(throws<std::out_of_range>([&] { [[maybe_unused]] auto _ = symbols.name(b + 1); }));
+    };
+
+    "symbol_table can be used at compile time"_test = [] {
+        static_assert([] {
+            auto symbols = symbol_table{};
+            const auto a = symbols.intern(u8"abc");
+            return symbols.intern(u8"xyz") != a and symbols.intern(u8"abc") == a;
+        }());
+    };
+
+    "symbol_table keeps symbols when it grows"_test = [] {
+        auto symbols = symbol_table{};
+        for (const auto i : std::views::iota(0, 1000)) {
+            const auto name = std::format("identifier{}", i);
+            const auto id   = symbols.intern(std::u8string{ name.begin(), name.end() });
+            expect(id == first_identifier_id + static_cast<symbol_id>(i));
+        }
+        for (const auto i : std::views::iota(0, 1000)) {
+            const auto name = std::format("identifier{}", i);
+            const auto id   = symbols.intern(std::u8string{ name.begin(), name.end() });
+            expect(id == first_identifier_id + static_cast<symbol_id>(i));
+            expect(symbols.name(id) == std::u8string{ name.begin(), name.end() });
+        }
+        expect(symbols.size() == 1000);
+    };
+}
@@ -0,0 +1,240 @@
+#include <boost/ut.hpp> // import boost.ut;
+
+#include <cstddef>
+#include <format>
+#include <memory_resource>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "hycc/ast.hpp"
+#include "hycc/parser.hpp"
+#include "hycc/token_stream.hpp"
+#include "hycc/tokenizer.hpp"
+
+#include "token_buffer_comparison.hpp"
+
+/// Pipe which read end contains \p str.
+///
+/// \p str has to fit in the pipe buffer.
+class pipe_with {
+    int fds_[2];
+
+  public:
+    explicit pipe_with(const std::u8string_view str) {
+        if (::pipe(fds_) != 0) throw std::runtime_error{ "pipe failed" };
+        if (::write(fds_[1], str.data(), str.size()) != static_cast<ssize_t>(str.size()))
+            throw std::runtime_error{ "write to pipe failed" };
+        ::close(fds_[1]);
+    }
+    pipe_with(const pipe_with&)            = delete;
+    pipe_with& operator=(const pipe_with&) = delete;
+    ~pipe_with() { ::close(fds_[0]); }
+
+    [[nodiscard]] auto fd() const -> int { return fds_[0]; }
+};
+
+/// Checks that token_stream produces same tokens as tokenize with every chunk size.
+void expect_same_as_tokenize(const std::u8string_view str,
+                             const hycc::trivia_mode mode,
+                             const hycc::operator_mode operators =
+                                 hycc::operator_mode::single_character) {
+    auto source         = hycc::source_code{ std::u8string{ str } };
+    const auto expected = hycc::tokenize(source, mode, operators);
+
+    for (const auto chunk_size : std::views::iota(1uz, str.size() + 2)) {
+        const auto pipe = pipe_with{ str };
+        auto stream     = hycc::token_stream{ pipe.fd(), mode, operators, chunk_size };
+        const auto at   = std::format("chunk size {}", chunk_size);
+        hycc::support::expect_same_tokens(stream, expected, at);
+    }
+}
+
+int main() {
+    using namespace boost::ut;
+    using namespace hycc;
+    using enum operator_mode;
+
+    "empty stream has no tokens"_test = [] {
+        const auto pipe = pipe_with{ u8"" };
+        auto stream     = token_stream{ pipe.fd() };
+        expect(not stream.next().has_value());
+        expect(not stream.next().has_value());
+    };
+
+    "chunk size can not be zero"_test = [] {
+        expect(throws<std::invalid_argument>([] {
+            [[maybe_unused]] auto _ =
+                token_stream{ 0, trivia_mode::in_stream, single_character, 0 };
+        }));
+    };
+
+    "token_stream tokenizes like tokenize"_test = [] {
+        constexpr auto str = std::u8string_view{ u8"foo  bar123\n  4567 +-*/ (x, y);" };
+        expect_same_as_tokenize(str, trivia_mode::in_stream);
+        expect_same_as_tokenize(str, trivia_mode::side_table);
+    };
+
+    "token_stream carries literals and comments across chunks"_test = [] {
+        constexpr auto str = std::u8string_view{
+            u8"a \"literal with \\\" escape\" /* block\n comment */b// line\n//comment\nc/d `x`"
+        };
+        expect_same_as_tokenize(str, trivia_mode::in_stream);
+        expect_same_as_tokenize(str, trivia_mode::side_table);
+    };
+
+    "token_stream carries escapes and raw literals across chunks"_test = [] {
+        constexpr auto str =
+            std::u8string_view{ u8R"(a 'x\\' b 'y\'' c '''raw '' literal''' d '' e ''' f)" };
+        expect_same_as_tokenize(str, trivia_mode::in_stream);
+        expect_same_as_tokenize(str, trivia_mode::side_table);
+    };
+
+    "token_stream munches operators across chunks"_test = [] {
+        constexpr auto str = std::u8string_view{ u8"x-- --y a&&b p->q a::b ::c x<=>y x<<=1 a-->b" };
+        for (const auto mode : { trivia_mode::in_stream, trivia_mode::side_table }) {
+            expect_same_as_tokenize(str, mode, maximal_munch);
+        }
+
+        const auto pipe = pipe_with{ str };
+        auto stream     = token_stream{ pipe.fd(), trivia_mode::side_table, maximal_munch, 1 };
+        auto operators  = std::vector<std::u8string>{};
+        for (const auto& t : stream) {
+            if (t.type != token_type::identifier and t.type != token_type::integer)
+                operators.emplace_back(t.sv);
+        }
+        expect(operators
+               == std::vector<std::u8string>{
+                   u8"--", u8"--", u8"&&", u8"->", u8"::", u8"::", u8"<=>", u8"<<=", u8"--", u8">"
+               });
+    };
+
+    "token_stream surfaces the diagnostics of the tokenizer"_test = [] {
+        constexpr auto str = std::u8string_view{ u8"a ää b \"\xff\" \xfe\xfe c" };
+        expect_same_as_tokenize(str, trivia_mode::in_stream);
+        expect_same_as_tokenize(str, trivia_mode::side_table);
+
+        const auto pipe = pipe_with{ str };
+        auto stream     = token_stream{ pipe.fd() };
+        for ([[maybe_unused]] const auto& _ : stream) {}
+        expect(stream.diagnostics().size() == 3uz);
+        expect(stream.diagnostics()[0].kind == diagnostic_kind::unexpected_characters);
+        expect(stream.diagnostics()[1].kind == diagnostic_kind::invalid_utf8_in_literal);
+        expect(stream.diagnostics()[2].kind == diagnostic_kind::invalid_utf8);
+    };
+
+    "token_stream discards comments while reading them"_test = [] {
+        for (const auto mode : { trivia_mode::in_stream, trivia_mode::side_table }) {
+            auto str = std::u8string{ u8"a /*" };
+            str.append(50'000, u8'*');
+            str.append(u8"*/ b // ");
+            str.append(10'000, u8'x');
+            str.append(u8"\nc");
+
+            const auto pipe = pipe_with{ str };
+            auto stream     = token_stream{ pipe.fd(), mode, single_character, 16 };
+
+            auto significant = std::vector<std::u8string>{};
+            for (const auto& t : stream) {
+                // Comments are not held in memory as a whole.
+                expect(stream.buffered() <= 32uz) << stream.buffered();
+                if (t.type != token_type::whitespace) significant.emplace_back(t.sv);
+            }
+            expect(significant == std::vector<std::u8string>{ u8"a", u8"b", u8"c" });
+        }
+    };
+
+    "token_stream reads long tokens across many chunks"_test = [] {
+        auto str = std::u8string{ u8"a \"" };
+        str.append(30'000, u8'x');
+        str.append(u8"\" ");
+        str.append(30'000, u8'y');
+        str.append(u8" b");
+
+        const auto pipe = pipe_with{ str };
+        auto stream     = token_stream{ pipe.fd(), trivia_mode::side_table, single_character, 7 };
+
+        auto lengths = std::vector<std::size_t>{};
+        for (const auto& t : stream) lengths.push_back(t.sv.size());
+        expect(lengths == std::vector<std::size_t>{ 1, 30'002, 30'000, 1 });
+    };
+
+    "token_stream reads top level units for parser_t"_test = [] {
+        constexpr auto str = std::u8string_view{ u8"{ {} }\n{ x; } /* } */\n}; y" };
+        for (const auto mode : { trivia_mode::in_stream, trivia_mode::side_table }) {
+            const auto pipe = pipe_with{ str };
+            auto stream     = token_stream{ pipe.fd(), mode, single_character, 3 };
+
+            auto units   = std::vector<std::u8string>{};
+            auto offsets = std::vector<std::uint64_t>{};
+            auto scope   = ast::scope_node{};
+            scope.mark_as_global_scope();
+            while (const auto unit = stream.next_unit()) {
+                units.emplace_back(unit->tokens.source_sv());
+                offsets.push_back(unit->offset);
+
+                auto parser = parser_t{ unit->tokens, error_mode::recover };
+                expect(scope.push(parser).has_value());
+                expect(parser.all_parsed());
+            }
+
+            if (mode == trivia_mode::in_stream) {
+                expect(units
+                       == std::vector<std::u8string>{
+                           u8"{ {} }", u8"\n{ x; }", u8" /* } */\n}", u8";", u8" y" });
+                expect(offsets == std::vector<std::uint64_t>{ 0, 6, 13, 23, 24 });
+            } else {
+                expect(units
+                       == std::vector<std::u8string>{
+                           u8"{ {} }", u8"{ x; }", u8"}", u8";", u8"y" });
+                expect(offsets == std::vector<std::uint64_t>{ 0, 7, 22, 23, 25 });
+            }
+            // Two nested scopes and errors at }, ; and y.
+            expect(scope.get_ordered_property().size() == 5uz);
+        }
+    };
+
+    "units are allocated from the memory resource of token_stream"_test = [] {
+        auto resource   = std::pmr::monotonic_buffer_resource{};
+        const auto pipe = pipe_with{ u8"a; b;" };
+        const auto mode = trivia_mode::side_table;
+        auto stream     = token_stream{ pipe.fd(), mode, single_character, 2, &resource };
+        auto units      = 0uz;
+        while (const auto unit = stream.next_unit()) {
+            expect(unit->tokens.resource() == &resource);
+            ++units;
+        }
+        expect(units == 2uz);
+    };
+
+    "token_stream handles unterminated literals and comments at the end"_test = [] {
+        expect_same_as_tokenize(u8"foo 'unterminated", trivia_mode::in_stream);
+        expect_same_as_tokenize(u8"foo /* unterminated", trivia_mode::side_table);
+        expect_same_as_tokenize(u8"foo // no newline", trivia_mode::side_table);
+    };
+
+    "token_stream reads sources larger than a chunk"_test = [] {
+        auto str = std::u8string{};
+        for (const auto i : std::views::iota(0, 1000)) {
+            const auto line = std::format("id{} = {};\n", i, i * i);
+            str.append(line.begin(), line.end());
+        }
+        const auto pipe = pipe_with{ str };
+        auto stream     = token_stream{ pipe.fd(), trivia_mode::side_table, single_character, 100 };
+
+        auto n = 0uz;
+        for (const auto& t : stream) {
+            // Every line has 4 tokens: id = integer ;
+            if (n % 4 == 0) {
+                expect(t.type == token_type::identifier);
+                expect(t.position.row == n / 4);
+                expect(t.position.column == 1);
+            }
+            ++n;
+        }
+        expect(n == 4 * 1000);
+    };
+}
@@ -4,6 +4,7 @@
 #include <array>
 #include <cstddef>
 #include <format>
+#include <memory_resource>
 #include <ranges>
 #include <source_location>
 #include <string>
@@ -22,14 +23,17 @@ struct mock_token {
 };
 
 void expect_token(const mock_token& expected,
-                  const hycc::token& got,
+                  const hycc::token_buffer& buffer,
+                  const std::size_t index,
                   const std::source_location loc = std::source_location::current()) {
     using namespace boost::ut;
 
+    const auto& got         = buffer[index];
+    const auto got_sv       = buffer.sv(got);
     const auto loc_info     = std::format("[actually at: {}]\n\n\t", loc.line());
     const auto error_end    = std::format("\n");
     const auto expected_str = std::string{ expected.str.begin(), expected.str.end() };
-    const auto got_str      = std::string{ got.sv_in_source.begin(), got.sv_in_source.end() };
+    const auto got_str      = std::string{ got_sv.begin(), got_sv.end() };
 
     expect(expected.type == got.type) << loc_info
                                       << std::format("expected hycc::token_type {}, got {} for: {}",
@@ -38,14 +42,16 @@ void expect_token(const mock_token& expected,
                                                      got_str)
                                       << error_end;
 
-    expect(expected.str == got.sv_in_source)
+    expect(expected.str == got_sv)
         << loc_info << std::format("expected: {}, got {}", expected_str, got_str) << error_end;
 
-    expect(expected.row == got.row)
-        << loc_info << std::format("expected row {}, got row {}", expected.row, got.row)
+    const auto got_position = buffer.position(got);
+    expect(expected.row == got_position.row)
+        << loc_info << std::format("expected row {}, got row {}", expected.row, got_position.row)
         << error_end;
-    expect(expected.column == got.column)
-        << loc_info << std::format("expected column {}, got column {}", expected.column, got.column)
+    expect(expected.column == got_position.column)
+        << loc_info
+        << std::format("expected column {}, got column {}", expected.column, got_position.column)
         << error_end;
 }
 
@@ -112,7 +118,7 @@ int main() {
                                           { 0x0050, char_class::id },
                                           { 0x0051, char_class::id },
                                           { 0x0052, char_class::id },
-                                          { 0x0054, char_class::id },
+                                          { 0x0053, char_class::id },
                                           { 0x0054, char_class::id },
                                           { 0x0055, char_class::id },
                                           { 0x0056, char_class::id },
@@ -185,12 +191,22 @@ int main() {
         auto source_code1  = source_code{ std::u8string{ u8"a\nb c\t" } };
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 6);
-        expect_token({ token_type::identifier, u8"a", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::whitespace, u8"\n", 1, 0 }, tokens1[1]);
-        expect_token({ token_type::identifier, u8"b", 1, 1 }, tokens1[2]);
-        expect_token({ token_type::whitespace, u8" ", 1, 2 }, tokens1[3]);
-        expect_token({ token_type::identifier, u8"c", 1, 3 }, tokens1[4]);
-        expect_token({ token_type::whitespace, u8"\t", 1, 4 }, tokens1[5]);
+        expect_token({ token_type::identifier, u8"a", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::whitespace, u8"\n", 1, 0 }, tokens1, 1);
+        expect_token({ token_type::identifier, u8"b", 1, 1 }, tokens1, 2);
+        expect_token({ token_type::whitespace, u8" ", 1, 2 }, tokens1, 3);
+        expect_token({ token_type::identifier, u8"c", 1, 3 }, tokens1, 4);
+        expect_token({ token_type::whitespace, u8"\t", 1, 4 }, tokens1, 5);
+    };
+
+    "newline at the beginning of source starts a new row"_test = [] {
+        using namespace hycc;
+
+        auto source_code1  = source_code{ std::u8string{ u8"\na" } };
+        const auto tokens1 = tokenize(source_code1);
+        expect(tokens1.size() == 2);
+        expect_token({ token_type::whitespace, u8"\n", 1, 0 }, tokens1, 0);
+        expect_token({ token_type::identifier, u8"a", 1, 1 }, tokens1, 1);
     };
 
     "whitespace tokens are concatted"_test = [] {
@@ -199,16 +215,16 @@ int main() {
         auto source_code1  = source_code{ std::u8string{ u8"a\n \tbc" } };
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 3);
-        expect_token({ token_type::identifier, u8"a", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::whitespace, u8"\n \t", 1, 0 }, tokens1[1]);
-        expect_token({ token_type::identifier, u8"bc", 1, 3 }, tokens1[2]);
+        expect_token({ token_type::identifier, u8"a", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::whitespace, u8"\n \t", 1, 0 }, tokens1, 1);
+        expect_token({ token_type::identifier, u8"bc", 1, 3 }, tokens1, 2);
 
         auto source_code2  = hycc::source_code{ std::u8string{ u8"ab \n\tc" } };
         const auto tokens2 = hycc::tokenize(source_code2);
         expect(tokens2.size() == 3);
-        expect_token({ token_type::identifier, u8"ab", 0, 1 }, tokens2[0]);
-        expect_token({ token_type::whitespace, u8" \n\t", 0, 3 }, tokens2[1]);
-        expect_token({ token_type::identifier, u8"c", 1, 2 }, tokens2[2]);
+        expect_token({ token_type::identifier, u8"ab", 0, 1 }, tokens2, 0);
+        expect_token({ token_type::whitespace, u8" \n\t", 0, 3 }, tokens2, 1);
+        expect_token({ token_type::identifier, u8"c", 1, 2 }, tokens2, 2);
     };
 
     "integer tokens are regonized"_test = [] {
@@ -223,9 +239,9 @@ int main() {
         for (const auto [i, token] : foo) {
             expect(std::get<1>(token).type
                    == ((i % 2) ? token_type::whitespace : token_type::integer));
-            expect(std::get<1>(token).sv_in_source == std::u8string{ std::get<0>(token) });
-            expect(std::get<1>(token).row == 0);
-            expect(std::get<1>(token).column == static_cast<std::size_t>(i) + 1);
+            expect(tokens1.sv(std::get<1>(token)) == std::u8string{ std::get<0>(token) });
+            expect(tokens1.position(std::get<1>(token)).row == 0);
+            expect(tokens1.position(std::get<1>(token)).column == static_cast<std::size_t>(i) + 1);
         }
     };
 
@@ -234,13 +250,13 @@ int main() {
         auto source_code1  = source_code{ std::u8string{ u8"123\nabc\n 45\n678" } };
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 7);
-        expect_token({ token_type::integer, u8"123", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::whitespace, u8"\n", 1, 0 }, tokens1[1]);
-        expect_token({ token_type::identifier, u8"abc", 1, 1 }, tokens1[2]);
-        expect_token({ token_type::whitespace, u8"\n ", 2, 0 }, tokens1[3]);
-        expect_token({ token_type::integer, u8"45", 2, 2 }, tokens1[4]);
-        expect_token({ token_type::whitespace, u8"\n", 3, 0 }, tokens1[5]);
-        expect_token({ token_type::integer, u8"678", 3, 1 }, tokens1[6]);
+        expect_token({ token_type::integer, u8"123", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::whitespace, u8"\n", 1, 0 }, tokens1, 1);
+        expect_token({ token_type::identifier, u8"abc", 1, 1 }, tokens1, 2);
+        expect_token({ token_type::whitespace, u8"\n ", 2, 0 }, tokens1, 3);
+        expect_token({ token_type::integer, u8"45", 2, 2 }, tokens1, 4);
+        expect_token({ token_type::whitespace, u8"\n", 3, 0 }, tokens1, 5);
+        expect_token({ token_type::integer, u8"678", 3, 1 }, tokens1, 6);
     };
 
     "literal tokens are tokenized"_test = [] {
@@ -250,11 +266,11 @@ int main() {
 
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 5);
-        expect_token({ token_type::literal, u8"\"123\"", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::identifier, u8"_", 0, 6 }, tokens1[1]);
-        expect_token({ token_type::literal, u8"`abc`", 0, 7 }, tokens1[2]);
-        expect_token({ token_type::identifier, u8"_", 0, 12 }, tokens1[3]);
-        expect_token({ token_type::literal, u8"'\n  '", 0, 13 }, tokens1[4]);
+        expect_token({ token_type::literal, u8"\"123\"", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::identifier, u8"_", 0, 6 }, tokens1, 1);
+        expect_token({ token_type::literal, u8"`abc`", 0, 7 }, tokens1, 2);
+        expect_token({ token_type::identifier, u8"_", 0, 12 }, tokens1, 3);
+        expect_token({ token_type::literal, u8"'\n  '", 0, 13 }, tokens1, 4);
     };
 
     "line breaks in literal tokens effect source position"_test = [] {
@@ -264,8 +280,8 @@ int main() {
 
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 2);
-        expect_token({ token_type::literal, u8"'\n\n\n\n  '", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::identifier, u8"abc", 4, 4 }, tokens1[1]);
+        expect_token({ token_type::literal, u8"'\n\n\n\n  '", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::identifier, u8"abc", 4, 4 }, tokens1, 1);
     };
 
     "empty literal tokens are possible"_test = [] {
@@ -275,11 +291,11 @@ int main() {
 
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 5);
-        expect_token({ token_type::literal, u8"''", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::identifier, u8"x", 0, 3 }, tokens1[1]);
-        expect_token({ token_type::literal, u8"\"\"", 0, 4 }, tokens1[2]);
-        expect_token({ token_type::identifier, u8"x", 0, 6 }, tokens1[3]);
-        expect_token({ token_type::literal, u8"``", 0, 7 }, tokens1[4]);
+        expect_token({ token_type::literal, u8"''", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::identifier, u8"x", 0, 3 }, tokens1, 1);
+        expect_token({ token_type::literal, u8"\"\"", 0, 4 }, tokens1, 2);
+        expect_token({ token_type::identifier, u8"x", 0, 6 }, tokens1, 3);
+        expect_token({ token_type::literal, u8"``", 0, 7 }, tokens1, 4);
     };
 
     "escaping characters in literal tokens is possible"_test = [] {
@@ -289,8 +305,8 @@ int main() {
 
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 2);
-        expect_token({ token_type::literal, u8R"('\'\'')", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::literal, u8R"("\"\"")", 0, 7 }, tokens1[1]);
+        expect_token({ token_type::literal, u8R"('\'\'')", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::literal, u8R"("\"\"")", 0, 7 }, tokens1, 1);
     };
 
     "source can stop in middle of literal token"_test = [] {
@@ -300,7 +316,42 @@ int main() {
 
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 1);
-        expect_token({ token_type::literal, u8R"('ab)", 0, 1 }, tokens1[0]);
+        expect_token({ token_type::literal, u8R"('ab)", 0, 1 }, tokens1, 0);
+    };
+
+    "escapes are handled in literal tokens longer than vectorized search width"_test = [] {
+        using namespace hycc;
+
+        auto literal = std::u8string{ u8"\"" };
+        for (auto i = 0uz; i < 100; ++i) literal.append(i % 7 == 0 ? u8"\\\" \\\\" : u8"abc ");
+        literal.append(u8"\"");
+
+        auto source_code1  = source_code{ literal + u8"x" };
+        const auto tokens1 = tokenize(source_code1);
+        expect(tokens1.size() == 2);
+        expect_token({ token_type::literal, literal, 0, 1 }, tokens1, 0);
+        expect_token({ token_type::identifier, u8"x", 0, literal.size() + 1 }, tokens1, 1);
+    };
+
+    "raw literal tokens end at three delimiters and have no escapes"_test = [] {
+        using namespace hycc;
+
+        auto source_code1 = source_code{ std::u8string{ u8R"("""a "b" ""\""" '''c\''' ``````)" } };
+
+        const auto tokens1 = tokenize(source_code1, trivia_mode::side_table);
+        expect(tokens1.size() == 3);
+        expect_token({ token_type::literal, u8R"("""a "b" ""\""")", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::literal, u8R"('''c\''')", 0, 17 }, tokens1, 1);
+        expect_token({ token_type::literal, u8R"(``````)", 0, 26 }, tokens1, 2);
+    };
+
+    "source can stop in middle of raw literal token"_test = [] {
+        using namespace hycc;
+
+        const auto state = run_tokenizer(u8R"(```a``)", trivia_mode::side_table);
+        expect(state.unterminated);
+        expect(state.tokens.size() == 1uz);
+        expect(state.tokens.front().length == 6u);
     };
 
     "semantic scope operators are tokenized"_test = [] {
@@ -314,7 +365,7 @@ int main() {
         for (const auto [i_int, c] : corrects | std::views::enumerate) {
             const auto i = static_cast<std::size_t>(i_int);
             expect_token({ token_type::semantic_scope_operator, std::u8string{ c }, 0, i + 1 },
-                         tokens1[i]);
+                         tokens1, i);
         }
 
         auto source_code2 = source_code{ std::u8string{ u8"[(   )]" } };
@@ -323,14 +374,14 @@ int main() {
         expect(tokens2.size() == 5);
 
         expect_token({ token_type::semantic_scope_operator, std::u8string{ u8'[' }, 0, 1 },
-                     tokens2[0]);
+                     tokens2, 0);
         expect_token({ token_type::semantic_scope_operator, std::u8string{ u8'(' }, 0, 2 },
-                     tokens2[1]);
-        expect_token({ token_type::whitespace, u8"   ", 0, 3 }, tokens2[2]);
+                     tokens2, 1);
+        expect_token({ token_type::whitespace, u8"   ", 0, 3 }, tokens2, 2);
         expect_token({ token_type::semantic_scope_operator, std::u8string{ u8')' }, 0, 6 },
-                     tokens2[3]);
+                     tokens2, 3);
         expect_token({ token_type::semantic_scope_operator, std::u8string{ u8']' }, 0, 7 },
-                     tokens2[4]);
+                     tokens2, 4);
     };
 
     "operators are tokenized"_test = [] {
@@ -347,9 +398,9 @@ int main() {
             const auto column_of_non_whitespace = 2 * i + 1;
             expect_token(
                 { token_type::operator_token, std::u8string{ c }, 0, column_of_non_whitespace },
-                tokens1[2 * i]);
+                tokens1, 2 * i);
             expect_token({ token_type::whitespace, u8" ", 0, column_of_non_whitespace + 1 },
-                         tokens1[2 * i + 1]);
+                         tokens1, 2 * i + 1);
         }
     };
 
@@ -364,7 +415,7 @@ int main() {
         for (const auto [i_s, c] : corrects | std::views::enumerate) {
             const auto i = static_cast<std::size_t>(i_s);
 
-            expect_token({ token_type::operator_token, std::u8string{ c }, 0, i + 1 }, tokens1[i]);
+            expect_token({ token_type::operator_token, std::u8string{ c }, 0, i + 1 }, tokens1, i);
         }
     };
 
@@ -374,11 +425,11 @@ int main() {
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 5);
 
-        expect_token({ token_type::identifier, u8"a", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::whitespace, u8" ", 0, 2 }, tokens1[1]);
-        expect_token({ token_type::identifier, u8"b", 0, 3 }, tokens1[2]);
-        expect_token({ token_type::whitespace, u8" ", 0, 4 }, tokens1[3]);
-        expect_token({ token_type::identifier, u8"c", 0, 5 }, tokens1[4]);
+        expect_token({ token_type::identifier, u8"a", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::whitespace, u8" ", 0, 2 }, tokens1, 1);
+        expect_token({ token_type::identifier, u8"b", 0, 3 }, tokens1, 2);
+        expect_token({ token_type::whitespace, u8" ", 0, 4 }, tokens1, 3);
+        expect_token({ token_type::identifier, u8"c", 0, 5 }, tokens1, 4);
     };
 
     "idnentifier tokens are concatted"_test = [] {
@@ -387,9 +438,9 @@ int main() {
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 3);
 
-        expect_token({ token_type::identifier, u8"abc", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::whitespace, u8" ", 0, 4 }, tokens1[1]);
-        expect_token({ token_type::identifier, u8"def", 0, 5 }, tokens1[2]);
+        expect_token({ token_type::identifier, u8"abc", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::whitespace, u8" ", 0, 4 }, tokens1, 1);
+        expect_token({ token_type::identifier, u8"def", 0, 5 }, tokens1, 2);
     };
 
     "identifier can not begin with number"_test = [] {
@@ -398,10 +449,10 @@ int main() {
         const auto tokens1 = tokenize(source_code1);
         expect(tokens1.size() == 4);
 
-        expect_token({ token_type::integer, u8"0", 0, 1 }, tokens1[0]);
-        expect_token({ token_type::identifier, u8"x0x", 0, 2 }, tokens1[1]);
-        expect_token({ token_type::whitespace, u8" ", 0, 5 }, tokens1[2]);
-        expect_token({ token_type::identifier, u8"x00x00", 0, 6 }, tokens1[3]);
+        expect_token({ token_type::integer, u8"0", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::identifier, u8"x0x", 0, 2 }, tokens1, 1);
+        expect_token({ token_type::whitespace, u8" ", 0, 5 }, tokens1, 2);
+        expect_token({ token_type::identifier, u8"x00x00", 0, 6 }, tokens1, 3);
     };
 
     "line comments are skipped"_test = [] {
@@ -414,9 +465,9 @@ line_three)" } };
         expect(tokens1.size() == 3);
 
         // Newline at line 1 column 0.
-        expect_token({ token_type::identifier, u8"line_one", 1, 1 }, tokens1[0]);
-        expect_token({ token_type::whitespace, u8" ", 1, 9 }, tokens1[1]);
-        expect_token({ token_type::identifier, u8"line_three", 3, 1 }, tokens1[2]);
+        expect_token({ token_type::identifier, u8"line_one", 1, 1 }, tokens1, 0);
+        expect_token({ token_type::whitespace, u8" ", 1, 9 }, tokens1, 1);
+        expect_token({ token_type::identifier, u8"line_three", 3, 1 }, tokens1, 2);
     };
 
     "line comment can be last and first line of source"_test = [] {
@@ -431,15 +482,15 @@ foo
 // last line)" } };
         const auto tokens2 = tokenize(source_code2);
         expect(tokens2.size() == 2);
-        expect_token({ token_type::identifier, u8"foo", 1, 1 }, tokens2[0]);
-        expect_token({ token_type::whitespace, u8"\n", 2, 0 }, tokens2[1]);
+        expect_token({ token_type::identifier, u8"foo", 1, 1 }, tokens2, 0);
+        expect_token({ token_type::whitespace, u8"\n", 2, 0 }, tokens2, 1);
 
         auto source_code3  = source_code{ std::u8string{ u8R"(// first line
 foo// middle
 // last line)" } };
         const auto tokens3 = tokenize(source_code3);
         expect(tokens3.size() == 1);
-        expect_token({ token_type::identifier, u8"foo", 1, 1 }, tokens3[0]);
+        expect_token({ token_type::identifier, u8"foo", 1, 1 }, tokens3, 0);
     };
 
     "line comment can be empty"_test = [] {
@@ -454,8 +505,8 @@ foo
 //)" } };
         const auto tokens2 = tokenize(source_code2);
         expect(tokens2.size() == 2);
-        expect_token({ token_type::identifier, u8"foo", 1, 1 }, tokens2[0]);
-        expect_token({ token_type::whitespace, u8"\n", 2, 0 }, tokens2[1]);
+        expect_token({ token_type::identifier, u8"foo", 1, 1 }, tokens2, 0);
+        expect_token({ token_type::whitespace, u8"\n", 2, 0 }, tokens2, 1);
 
         auto source_code3 = source_code{ std::u8string{ u8R"(// first line
 foo//
@@ -463,7 +514,7 @@ foo//
         //
         const auto tokens3 = tokenize(source_code3);
         expect(tokens3.size() == 1);
-        expect_token({ token_type::identifier, u8"foo", 1, 1 }, tokens3[0]);
+        expect_token({ token_type::identifier, u8"foo", 1, 1 }, tokens3, 0);
     };
 
     "block comments are skipped"_test = [] {
@@ -476,9 +527,9 @@ foo//
         expect(tokens1.size() == 3);
 
         // Newline at line 1 column 0.
-        expect_token({ token_type::identifier, u8"line_one", 1, 3 }, tokens1[0]);
-        expect_token({ token_type::whitespace, u8" ", 1, 11 }, tokens1[1]);
-        expect_token({ token_type::identifier, u8"line_three", 3, 3 }, tokens1[2]);
+        expect_token({ token_type::identifier, u8"line_one", 1, 3 }, tokens1, 0);
+        expect_token({ token_type::whitespace, u8" ", 1, 11 }, tokens1, 1);
+        expect_token({ token_type::identifier, u8"line_three", 3, 3 }, tokens1, 2);
     };
 
     "block comment can be on last and first line of source"_test = [] {
@@ -494,14 +545,14 @@ last line*/)" } };
 last line*/)" } };
         const auto tokens2 = tokenize(source_code2);
         expect(tokens2.size() == 1);
-        expect_token({ token_type::identifier, u8"foo", 1, 3 }, tokens2[0]);
+        expect_token({ token_type::identifier, u8"foo", 1, 3 }, tokens2, 0);
 
         auto source_code3  = source_code{ std::u8string{ u8R"(/* first line
 */foo/* middle line
    last line */)" } };
         const auto tokens3 = tokenize(source_code3);
         expect(tokens3.size() == 1);
-        expect_token({ token_type::identifier, u8"foo", 1, 3 }, tokens3[0]);
+        expect_token({ token_type::identifier, u8"foo", 1, 3 }, tokens3, 0);
     };
 
     "block comment can be empty"_test = [] {
@@ -513,21 +564,263 @@ last line*/)" } };
         auto source_code2  = source_code{ std::u8string{ u8R"(/**/foo/**/)" } };
         const auto tokens2 = tokenize(source_code2);
         expect(tokens2.size() == 1);
-        expect_token({ token_type::identifier, u8"foo", 0, 5 }, tokens2[0]);
+        expect_token({ token_type::identifier, u8"foo", 0, 5 }, tokens2, 0);
+    };
+
+    "block comment does not end at asterisk of its begin delimiter"_test = [] {
+        using namespace hycc;
+        auto source_code1  = source_code{ std::u8string{ u8R"(/*/ foo */bar)" } };
+        const auto tokens1 = tokenize(source_code1);
+        expect(tokens1.size() == 1);
+        expect_token({ token_type::identifier, u8"bar", 0, 11 }, tokens1, 0);
     };
 
-    "Error tokens are tokenized"_test = [] {
+    "runs of unrecognized characters are single error tokens"_test = [] {
         using namespace hycc;
 
         const auto str     = std::array<char, 5>{ 0x01, 0x02, 0x03, 0x04, 0x05 };
-        auto source_code1  = source_code{ std::u8string{ str.begin(), str.end() } };
+        auto source_code1  = source_code{ std::u8string{ str.begin(), str.end() } + u8"a\x7f" };
         const auto tokens1 = tokenize(source_code1);
 
-        expect(tokens1.size() == 5);
-        for (const auto [i_s, c] : str | std::views::enumerate) {
-            const auto i  = static_cast<std::size_t>(i_s);
-            const auto c8 = static_cast<char8_t>(c);
-            expect_token({ token_type::error, std::u8string{ c8 }, 0, i + 1 }, tokens1[i]);
+        expect(tokens1.size() == 3);
+        expect_token({ token_type::error, std::u8string{ str.begin(), str.end() }, 0, 1 },
+                     tokens1,
+                     0);
+        expect_token({ token_type::identifier, u8"a", 0, 6 }, tokens1, 1);
+        expect_token({ token_type::error, u8"\x7f", 0, 7 }, tokens1, 2);
+    };
+
+    "error tokens are diagnosed"_test = [] {
+        using namespace hycc;
+
+        // Valid UTF-8 outside of literal, invalid UTF-8 and invalid UTF-8 inside of literal.
+        auto source_code1  = source_code{ std::u8string{ u8"a éé b \xc3\x28 '\xff'" } };
+        const auto tokens1 = tokenize(source_code1, trivia_mode::side_table);
+
+        expect(tokens1.size() == 6);
+        expect(tokens1[1].type == token_type::error and tokens1[1].length == 4u);
+        expect(tokens1[3].type == token_type::error and tokens1[3].length == 1u);
+
+        const auto expected = std::array{
+            tokenizer_diagnostic{ diagnostic_kind::unexpected_characters, 2, 4 },
+            tokenizer_diagnostic{ diagnostic_kind::invalid_utf8, 9, 1 },
+            tokenizer_diagnostic{ diagnostic_kind::invalid_utf8_in_literal, 13, 1 },
+        };
+        expect(std::ranges::equal(tokens1.diagnostics(), expected));
+    };
+
+    "long runs of invalid UTF-8 are a single error token"_test = [] {
+        using namespace hycc;
+
+        auto source_code1  = source_code{ std::u8string(100'000, char8_t{ 0xff }) };
+        const auto tokens1 = tokenize(source_code1);
+        expect(tokens1.size() == 1);
+        expect(tokens1.diagnostics().size() == 1);
+        expect(tokens1.diagnostics().front().kind == diagnostic_kind::invalid_utf8);
+    };
+
+    "tokens know if they are preceded by whitespace or comment"_test = [] {
+        using namespace hycc;
+        auto source_code1  = source_code{ std::u8string{ u8"a -b/**/+c" } };
+        const auto tokens1 = tokenize(source_code1);
+        expect(tokens1.size() == 6);
+
+        const auto expected = std::array{ false, false, true, false, true, false };
+        for (const auto [t, preceded] : std::views::zip(tokens1, expected)) {
+            expect(t.preceded_by_whitespace == preceded);
+        }
+    };
+
+    "trivia is stored in side table"_test = [] {
+        using namespace hycc;
+        auto source_code1  = source_code{ std::u8string{ u8"a  /*c*/b // x\n+\nc " } };
+        const auto tokens1 = tokenize(source_code1, trivia_mode::side_table);
+        expect(tokens1.mode() == trivia_mode::side_table);
+
+        expect(tokens1.size() == 4);
+        expect_token({ token_type::identifier, u8"a", 0, 1 }, tokens1, 0);
+        expect_token({ token_type::identifier, u8"b", 0, 9 }, tokens1, 1);
+        expect_token({ token_type::operator_token, u8"+", 1, 1 }, tokens1, 2);
+        expect_token({ token_type::identifier, u8"c", 2, 1 }, tokens1, 3);
+
+        const auto expected = std::array{ false, true, true, true };
+        for (const auto [t, preceded] : std::views::zip(tokens1, expected)) {
+            expect(t.preceded_by_whitespace == preceded);
         }
+
+        const auto trivia = tokens1.trivia();
+        expect(trivia.size() == 6);
+        const auto expected_trivia = std::array{
+            std::tuple{ token_type::whitespace, std::u8string_view{ u8"  " } },
+            std::tuple{ token_type::comment, std::u8string_view{ u8"/*c*/" } },
+            std::tuple{ token_type::whitespace, std::u8string_view{ u8" " } },
+            std::tuple{ token_type::comment, std::u8string_view{ u8"// x\n" } },
+            std::tuple{ token_type::whitespace, std::u8string_view{ u8"\n" } },
+            std::tuple{ token_type::whitespace, std::u8string_view{ u8" " } },
+        };
+        for (const auto [t, e] : std::views::zip(trivia, expected_trivia)) {
+            expect(t.type == std::get<0>(e));
+            expect(tokens1.sv(t) == std::get<1>(e));
+        }
+    };
+
+    "whitespace before token covers all trivia in side table mode"_test = [] {
+        using namespace hycc;
+        auto source_code1  = source_code{ std::u8string{ u8" a/**/ b+c " } };
+        const auto tokens1 = tokenize(source_code1, trivia_mode::side_table);
+        expect(tokens1.size() == 4);
+
+        const auto sv_of_whitespace_before = [&](const std::size_t i) {
+            const auto t = tokens1.whitespace_before(i);
+            return t ? tokens1.sv(t.value()) : std::u8string_view{ u8"[none]" };
+        };
+        expect(sv_of_whitespace_before(0) == u8" ");
+        expect(sv_of_whitespace_before(1) == u8"/**/ ");
+        expect(sv_of_whitespace_before(2) == u8"[none]");
+        expect(sv_of_whitespace_before(3) == u8"[none]");
+        expect(sv_of_whitespace_before(4) == u8" ");
+    };
+
+    "identifiers, keywords and operators get symbols"_test = [] {
+        using namespace hycc;
+        auto source_code1  = source_code{ std::u8string{ u8"foo bar foo in x + 12" } };
+        const auto tokens1 = tokenize(source_code1, trivia_mode::side_table);
+        expect(tokens1.size() == 7);
+
+        expect(tokens1[0].symbol == first_identifier_id);
+        expect(tokens1[1].symbol == first_identifier_id + 1);
+        expect(tokens1[2].symbol == tokens1[0].symbol);
+        expect(tokens1[3].symbol == keyword_id(u8"in"));
+        expect(tokens1[4].symbol == symbol_id{ u8'x' });
+        expect(tokens1[5].symbol == symbol_id{ u8'+' });
+        expect(tokens1[6].symbol == no_symbol);
+
+        expect(tokens1.symbols().size() == 2);
+        expect(tokens1.symbols().name(tokens1[1].symbol) == u8"bar");
+    };
+
+    "tokenize can be used in constant evaluation"_test = [] {
+        using namespace hycc;
+        constexpr auto count_tokens = [](const std::u8string_view str, const operator_mode ops) {
+            auto source = source_code{ std::u8string{ str } };
+            return tokenize(source, trivia_mode::side_table, ops).size();
+        };
+        static_assert(count_tokens(u8"a -> b /* c */", operator_mode::single_character) == 4uz);
+        static_assert(count_tokens(u8"a -> b /* c */", operator_mode::maximal_munch) == 3uz);
+
+        auto source = source_code{ std::u8string{ u8"a b" } };
+        expect(tokenize(source).resource() == nullptr);
+    };
+
+    "tokens are allocated from the given memory resource"_test = [] {
+        using namespace hycc;
+
+        /// Counts allocations, which are forwarded to the default resource.
+        struct counting_resource : std::pmr::memory_resource {
+            std::size_t allocations = 0;
+
+            auto do_allocate(const std::size_t bytes, const std::size_t alignment)
+                -> void* override {
+                ++allocations;
+                return std::pmr::get_default_resource()->allocate(bytes, alignment);
+            }
+            void do_deallocate(void* const p,
+                               const std::size_t bytes,
+                               const std::size_t alignment) override {
+                std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+            }
+            auto do_is_equal(const std::pmr::memory_resource& that) const noexcept
+                -> bool override {
+                return this == &that;
+            }
+        };
+
+        for (const auto mode : { trivia_mode::in_stream, trivia_mode::side_table }) {
+            auto resource      = counting_resource{};
+            auto source_code1  = source_code{ std::u8string{ u8"a + b /* c */ (d)" } };
+            const auto tokens1 =
+                tokenize(source_code1, mode, operator_mode::single_character, &resource);
+            const auto tokens2 = tokenize(source_code1, mode);
+
+            expect(tokens1.resource() == &resource);
+            expect(resource.allocations > 0uz);
+            expect(std::ranges::equal(tokens1, tokens2));
+            expect(std::ranges::equal(tokens1.trivia(), tokens2.trivia()));
+        }
+    };
+
+    "multi character operators are single tokens with maximal munch"_test = [] {
+        using namespace hycc;
+        auto source_code1  = source_code{ std::u8string{ u8"a<=>b c<<=1 d::e -> f+-g" } };
+        const auto tokens1 = tokenize(source_code1,
+                                      trivia_mode::side_table,
+                                      operator_mode::maximal_munch);
+
+        const auto expected = std::array{
+            std::tuple{ token_type::identifier, std::u8string_view{ u8"a" }, false },
+            std::tuple{ token_type::operator_token, std::u8string_view{ u8"<=>" }, false },
+            std::tuple{ token_type::identifier, std::u8string_view{ u8"b" }, false },
+            std::tuple{ token_type::identifier, std::u8string_view{ u8"c" }, true },
+            std::tuple{ token_type::operator_token, std::u8string_view{ u8"<<=" }, false },
+            std::tuple{ token_type::integer, std::u8string_view{ u8"1" }, false },
+            std::tuple{ token_type::identifier, std::u8string_view{ u8"d" }, true },
+            std::tuple{ token_type::semantic_scope_operator, std::u8string_view{ u8"::" }, false },
+            std::tuple{ token_type::identifier, std::u8string_view{ u8"e" }, false },
+            std::tuple{ token_type::operator_token, std::u8string_view{ u8"->" }, true },
+            std::tuple{ token_type::identifier, std::u8string_view{ u8"f" }, true },
+            std::tuple{ token_type::operator_token, std::u8string_view{ u8"+" }, false },
+            std::tuple{ token_type::operator_token, std::u8string_view{ u8"-" }, false },
+            std::tuple{ token_type::identifier, std::u8string_view{ u8"g" }, false },
+        };
+        expect(tokens1.size() == expected.size());
+        for (const auto [t, e] : std::views::zip(tokens1, expected)) {
+            expect(t.type == std::get<0>(e));
+            expect(tokens1.sv(t) == std::get<1>(e));
+            expect(t.preceded_by_whitespace == std::get<2>(e));
+            if (t.type != token_type::integer) expect(t.symbol == fixed_symbol_id(std::get<1>(e)));
+        }
+    };
+
+    "munched operators keep whitespace flags in postfix and prefix use"_test = [] {
+        using namespace hycc;
+        auto source_code1  = source_code{ std::u8string{ u8"x-- --y a&&b c && d p->q ::r s::t" } };
+        const auto tokens1 = tokenize(source_code1,
+                                      trivia_mode::side_table,
+                                      operator_mode::maximal_munch);
+
+        // Unary operators are told apart from binary ones by the whitespace before them.
+        const auto expected = std::array{
+            std::tuple{ std::u8string_view{ u8"x" }, false },
+            std::tuple{ std::u8string_view{ u8"--" }, false },
+            std::tuple{ std::u8string_view{ u8"--" }, true },
+            std::tuple{ std::u8string_view{ u8"y" }, false },
+            std::tuple{ std::u8string_view{ u8"a" }, true },
+            std::tuple{ std::u8string_view{ u8"&&" }, false },
+            std::tuple{ std::u8string_view{ u8"b" }, false },
+            std::tuple{ std::u8string_view{ u8"c" }, true },
+            std::tuple{ std::u8string_view{ u8"&&" }, true },
+            std::tuple{ std::u8string_view{ u8"d" }, true },
+            std::tuple{ std::u8string_view{ u8"p" }, true },
+            std::tuple{ std::u8string_view{ u8"->" }, false },
+            std::tuple{ std::u8string_view{ u8"q" }, false },
+            std::tuple{ std::u8string_view{ u8"::" }, true },
+            std::tuple{ std::u8string_view{ u8"r" }, false },
+            std::tuple{ std::u8string_view{ u8"s" }, true },
+            std::tuple{ std::u8string_view{ u8"::" }, false },
+            std::tuple{ std::u8string_view{ u8"t" }, false },
+        };
+        expect(tokens1.size() == expected.size());
+        for (const auto [t, e] : std::views::zip(tokens1, expected)) {
+            expect(tokens1.sv(t) == std::get<0>(e));
+            expect(t.preceded_by_whitespace == std::get<1>(e));
+        }
+    };
+
+    "operators are single characters by default"_test = [] {
+        using namespace hycc;
+        auto source_code1  = source_code{ std::u8string{ u8"a<=>b" } };
+        const auto tokens1 = tokenize(source_code1);
+        expect(tokens1.size() == 5);
+        expect(tokens1.operators() == operator_mode::single_character);
     };
 }
@@ -185,6 +185,20 @@ int main() {
         expect(not type.function().return_type.function().return_type.is_function());
     };
 
+    "type_node can detect function with return type separator tokenized with maximal munch"_test =
+        [] {
+            auto source       = source_code(u8"(foo) -> (bar) -> int = ");
+            const auto tokens =
+                tokenize(source, trivia_mode::side_table, operator_mode::maximal_munch);
+            auto parser       = parser_t{ tokens };
+            auto type         = ast::type_node{};
+            type.push(parser);
+
+            expect(type.is_function());
+            expect(type.function().return_type.is_function());
+            expect(type.function().return_type.function().return_type.is_regular_type());
+        };
+
     "type_node can detect syntax error when no return type separator"_test = [] {
         auto source       = source_code(u8"(foo: int, move bar: float) type = ");
         const auto tokens = tokenize(source);
@@ -211,4 +225,18 @@ int main() {
 
         expect(throws<syntax_error>([&] { type.push(parser); }));
     };
+
+    "type_node returns syntax error in recover mode"_test = [] {
+        auto source       = source_code(u8"(foo: int, move bar: float) ->  = ");
+        const auto tokens = tokenize(source);
+        auto parser       = parser_t{ tokens, error_mode::recover };
+        auto type         = ast::type_node{};
+
+        auto result = parse_result{};
+        expect(nothrow([&] { result = type.push(parser); }));
+        expect(not result.has_value());
+        expect(parser.diagnostics().size() == 1uz);
+        expect(not result.has_value()
+               and result.error().message(tokens) == "syntax error at [0:33]: =");
+    };
 }